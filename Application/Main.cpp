@@ -14,11 +14,36 @@ int main(int argc, char** argv)
 	nc::SeedRandom(static_cast<unsigned int>(time(nullptr)));
 	nc::SetFilePath("../resources");
 
+	// --bake-textures compresses the images into dds files the textures load instead, before they are packed
+	// --pack bakes the resources into an archive, a mounted archive is read before the loose files
+	// --watch reloads shaders, materials and textures when their files change, the loose files are read instead of the archive
+	bool bake = false;
+	bool pack = false;
+	bool watch = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg{ argv[i] };
+		if (arg == "--bake-textures") bake = true;
+		if (arg == "--pack") pack = true;
+		if (arg == "--watch") watch = true;
+	}
+	if (bake) SDL_Log("Baked %zu textures.", nc::TextureBaker::BakeDirectory("."));
+	if (pack) nc::Archive::Build("../resources.pak", ".");
+	if (watch) engine->Get<nc::ResourceSystem>()->WatchFiles();
+	else nc::MountArchive("../resources.pak");
+
 	// Load Scene
 	rapidjson::Document document;
 	bool success = nc::json::Load("scenes/main.scn", document);
 	scene->Read(document);
 
+	// resolve the effect uniforms once, they are set every frame
+	constexpr const char* effectsName = "shaders/effects.shdr";
+	constexpr nc::ResourceId effectsId{ effectsName };
+	auto shader = engine->Get<nc::ResourceSystem>()->Get<nc::Program>(effectsId, effectsName);
+	GLint timeUniform = shader->GetUniformHandle("time");
+	GLint tilingUniform = shader->GetUniformHandle("uv.tiling");
+
 	glm::vec3 translate{ 0 };
 	float angle = 0;
 
@@ -67,12 +92,10 @@ int main(int argc, char** argv)
 		}
 
 		// Update Shader
-		auto shader = engine->Get<nc::ResourceSystem>()->Get<nc::Program>("shaders/effects.shdr");
 		if (shader)
 		{
-			shader->Use();
-			shader->SetUniform("time", time);
-			shader->SetUniform("uv.tiling", glm::vec2{ 1 });
+			shader->SetUniform(timeUniform, time);
+			shader->SetUniform(tilingUniform, glm::vec2{ 1 });
 			//shader->SetUniform("uv.offset", glm::vec2{ 0, time });
 			//shader->SetUniform("strength", (std::sin(time * 4) + 1.0f) * 0.5f);
 			//shader->SetUniform("radius", 0.5f);
@@ -80,7 +103,7 @@ int main(int argc, char** argv)
 
 		engine->Get<nc::Renderer>()->BeginFrame();
 
-		scene->Draw(nullptr);
+		scene->Draw(engine->Get<nc::Renderer>());
 
 		engine->Get<nc::Renderer>()->EndFrame();
 	}
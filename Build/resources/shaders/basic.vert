@@ -7,9 +7,17 @@ layout(location = 2)in vec2 texcoord;
 out vec3 fs_color;
 out vec2 fs_texcoord;
 	
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 view_projection;
+};
+
+layout(std140, binding = 2) uniform Object
+{
+	mat4 model;
+};
 
 void main()
 {
@@ -25,7 +25,10 @@ struct Light
 };
 
 uniform Material material;
-uniform Light light;
+layout(std140, binding = 1) uniform Lights
+{
+	Light light;
+};
 
 uniform sampler2D color_sample;
 uniform float time;
@@ -24,11 +24,22 @@ struct Light
 };
 
 uniform Material material;
-uniform Light light;
+layout(std140, binding = 1) uniform Lights
+{
+	Light light;
+};
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 view_projection;
+};
+
+layout(std140, binding = 2) uniform Object
+{
+	mat4 model;
+};
 
 void main()
 {
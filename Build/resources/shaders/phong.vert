@@ -11,9 +11,17 @@ out VS_OUT
 	out vec2 fs_texcoord;
 } vs_out;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 view_projection;
+};
+
+layout(std140, binding = 2) uniform Object
+{
+	mat4 model;
+};
 
 void main()
 {
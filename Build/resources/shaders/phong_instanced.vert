@@ -0,0 +1,37 @@
+#version 430 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1)in vec3 normal;
+layout(location = 2)in vec2 texcoord;
+
+out VS_OUT
+{
+	out vec3 fs_position;
+	out vec3 fs_normal;
+	out vec2 fs_texcoord;
+} vs_out;
+
+layout(std430, binding = 0) buffer Instances
+{
+	mat4 instance_model[];
+};
+
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 view_projection;
+};
+
+void main()
+{
+	mat4 model = instance_model[gl_InstanceID];
+	mat4 model_view = view * model;
+	mat3 normal_matrix = transpose(inverse(mat3(model_view)));
+
+	vs_out.fs_normal = normalize(mat3(model_view) * normal);
+	vs_out.fs_position = vec3(model_view * vec4(position, 1));
+	vs_out.fs_texcoord = texcoord;
+
+	gl_Position = projection * view * model * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -24,7 +24,10 @@ struct Light
 };
 
 uniform Material material;
-uniform Light light;
+layout(std140, binding = 1) uniform Lights
+{
+	Light light;
+};
 
 uniform vec3 tint;
 layout (binding = 0) uniform sampler2D color_sample;
@@ -33,9 +36,9 @@ layout (binding = 1) uniform sampler2D normal_sample;
 void main()
 {
 //	generate the normals from the normal map
-	vec3 normal = texture(normal_sample, fs_in.texcoord).rgb;
-//	 convert rgb (0 <-> 1) to xyx (-1 <-> 1)
-	normal = normalize(normal * 2.0 - 1.0);
+//	 convert rg (0 <-> 1) to xy (-1 <-> 1), z is rebuilt so two channel (bc5) maps work
+	vec2 xy = texture(normal_sample, fs_in.texcoord).rg * 2.0 - 1.0;
+	vec3 normal = normalize(vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0))));
 
 //	Ambient
 	vec3 ambient = light.ambient;
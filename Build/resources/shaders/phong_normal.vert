@@ -3,7 +3,7 @@
 layout(location = 0) in vec3 position;
 layout(location = 1)in vec3 normal;
 layout(location = 2)in vec2 texcoord;
-layout(location = 2)in vec3 tangent;
+layout(location = 3)in vec4 tangent;
 
 out VS_OUT
 {
@@ -20,10 +20,21 @@ struct Light
 	vec3 specular;
 };
 
-uniform Light light;
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140, binding = 1) uniform Lights
+{
+	Light light;
+};
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 view_projection;
+};
+
+layout(std140, binding = 2) uniform Object
+{
+	mat4 model;
+};
 
 void main()
 {
@@ -34,10 +45,10 @@ void main()
 	vs_out.texcoord = texcoord;
 
 	vec3 N = normalize(normal_matrix * normal);
-	vec3 T = normalize(normal_matrix * tangent);
+	vec3 T = normalize(normal_matrix * tangent.xyz);
 //	 re-orthogonalize T with respect to N
 	T = normalize(T - dot(T, N) * N);
-	vec3 B = normalize(cross(N, T));
+	vec3 B = normalize(cross(N, T)) * tangent.w;
 	mat3 tbn = transpose(mat3(T, B, N));
 
 	vs_out.position = tbn * vec3(model_view * vec4(position, 1.0));
@@ -0,0 +1,61 @@
+#version 430 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1)in vec3 normal;
+layout(location = 2)in vec2 texcoord;
+layout(location = 3)in vec4 tangent;
+
+out VS_OUT
+{
+	out vec3 position;
+	out vec3 light_position;
+	out vec2 texcoord;
+} vs_out;
+
+struct Light
+{
+	vec4 position;
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+};
+
+layout(std140, binding = 1) uniform Lights
+{
+	Light light;
+};
+
+layout(std430, binding = 0) buffer Instances
+{
+	mat4 instance_model[];
+};
+
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 view_projection;
+};
+
+void main()
+{
+	mat4 model = instance_model[gl_InstanceID];
+	mat4 model_view = view * model;
+	mat3 normal_matrix = transpose(inverse(mat3(model_view)));
+
+	vs_out.position = vec3(model_view * vec4(position, 1));
+	vs_out.texcoord = texcoord;
+
+	vec3 N = normalize(normal_matrix * normal);
+	vec3 T = normalize(normal_matrix * tangent.xyz);
+//	 re-orthogonalize T with respect to N
+	T = normalize(T - dot(T, N) * N);
+	vec3 B = normalize(cross(N, T)) * tangent.w;
+	mat3 tbn = transpose(mat3(T, B, N));
+
+	vs_out.position = tbn * vec3(model_view * vec4(position, 1.0));
+	vs_out.light_position = tbn * vec3(light.position);
+	vs_out.texcoord = texcoord;
+
+	gl_Position = projection * view * model * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#version 430 core
+
+// variants are compiled with DIFFUSE_MAP, NORMAL_MAP, INSTANCED and FOG defined as the material needs
+
+in VS_OUT
+{
+	vec3 position;
+	vec3 normal;
+	vec3 light_position;
+	vec2 texcoord;
+	float distance;
+} fs_in;
+
+out vec4 outColor;
+
+struct Material
+{
+	vec3 diffuse;
+	vec3 specular;
+	float shininess;
+};
+
+struct Light
+{
+	vec4 position;
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+};
+
+uniform Material material;
+layout(std140, binding = 1) uniform Lights
+{
+	Light light;
+};
+
+#ifdef DIFFUSE_MAP
+layout(binding = 0) uniform sampler2D color_sample;
+#endif
+#ifdef NORMAL_MAP
+layout(binding = 1) uniform sampler2D normal_sample;
+#endif
+#ifdef FOG
+uniform vec3 fog_color = vec3(0.5, 0.5, 0.5);
+uniform float fog_density = 0.05;
+#endif
+
+void main()
+{
+#ifdef NORMAL_MAP
+	// convert the normal map rg (0 <-> 1) to xy (-1 <-> 1), z is rebuilt so two channel (bc5) maps work
+	vec2 xy = texture(normal_sample, fs_in.texcoord).rg * 2.0 - 1.0;
+	vec3 normal = normalize(vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0))));
+#else
+	vec3 normal = normalize(fs_in.normal);
+#endif
+
+	// Ambient
+	vec3 ambient = light.ambient;
+
+	// Diffuse
+	vec3 light_dir = normalize(fs_in.light_position - fs_in.position);
+	float intensity = max(dot(light_dir, normal), 0);
+	vec3 diffuse = material.diffuse * light.diffuse * intensity;
+
+	// Specular
+	vec3 specular = vec3(0);
+	if (intensity > 0)
+	{
+		vec3 view_dir = normalize(-fs_in.position);
+		vec3 reflection = reflect(-light_dir, normal);
+		intensity = max(dot(view_dir, reflection), 0);
+		intensity = pow(intensity, material.shininess);
+		specular = material.specular * light.specular * intensity;
+	}
+
+	vec4 color = vec4(ambient + diffuse, 1);
+#ifdef DIFFUSE_MAP
+	color *= texture(color_sample, fs_in.texcoord);
+#endif
+	color += vec4(specular, 1);
+
+#ifdef FOG
+	// exponential squared fog on the view distance
+	float fog = exp(-pow(fog_density * fs_in.distance, 2.0));
+	color.rgb = mix(fog_color, color.rgb, clamp(fog, 0.0, 1.0));
+#endif
+
+	outColor = color;
+}
@@ -0,0 +1,84 @@
+#version 430 core
+
+// variants are compiled with DIFFUSE_MAP, NORMAL_MAP, INSTANCED and FOG defined as the material needs
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texcoord;
+#ifdef NORMAL_MAP
+layout(location = 3) in vec4 tangent;
+#endif
+
+out VS_OUT
+{
+	vec3 position;
+	vec3 normal;
+	vec3 light_position;
+	vec2 texcoord;
+	float distance;
+} vs_out;
+
+struct Light
+{
+	vec4 position;
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+};
+
+layout(std140, binding = 1) uniform Lights
+{
+	Light light;
+};
+
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 view_projection;
+};
+
+#ifdef INSTANCED
+layout(std430, binding = 0) buffer Instances
+{
+	mat4 instance_model[];
+};
+#else
+layout(std140, binding = 2) uniform Object
+{
+	mat4 model;
+};
+#endif
+
+void main()
+{
+#ifdef INSTANCED
+	mat4 model = instance_model[gl_InstanceID];
+#endif
+	mat4 model_view = view * model;
+	mat3 normal_matrix = transpose(inverse(mat3(model_view)));
+
+	vec3 view_position = vec3(model_view * vec4(position, 1));
+	vec3 N = normalize(normal_matrix * normal);
+
+#ifdef NORMAL_MAP
+	// lighting is done in tangent space
+	vec3 T = normalize(normal_matrix * tangent.xyz);
+	// re-orthogonalize T with respect to N
+	T = normalize(T - dot(T, N) * N);
+	vec3 B = normalize(cross(N, T)) * tangent.w;
+	mat3 tbn = transpose(mat3(T, B, N));
+
+	vs_out.position = tbn * view_position;
+	vs_out.normal = vec3(0, 0, 1);
+	vs_out.light_position = tbn * vec3(light.position);
+#else
+	vs_out.position = view_position;
+	vs_out.normal = N;
+	vs_out.light_position = vec3(light.position);
+#endif
+	vs_out.texcoord = texcoord;
+	vs_out.distance = length(view_position);
+
+	gl_Position = projection * vec4(view_position, 1.0);
+}
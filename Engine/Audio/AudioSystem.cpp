@@ -1,5 +1,7 @@
 #include "AudioSystem.h"
 #include "Core/Utilities.h"
+#include "Core/FileSystem.h"
+#include <SDL.h>
 
 nc::AudioSystem audioSystem;
 
@@ -15,11 +17,11 @@ namespace nc
 
 	void AudioSystem::Shutdown()
 	{
-		for (auto& sound : sounds)
+		sounds.ForEach([](ResourceId id, FMOD::Sound* sound)
 		{
-			sound.second->release();
-		}
-		sounds.clear();
+			sound->release();
+		});
+		sounds.Clear();
 
 		fmodSystem->close();
 		fmodSystem->release();
@@ -32,20 +34,33 @@ namespace nc
 
 	void AudioSystem::AddAudio(const std::string& name, const std::string& filename)
 	{
-		if (sounds.find(string_tolower(name)) == sounds.end())
+		ResourceId id{ name };
+		if (sounds.Find(id) == nullptr)
 		{
+			File file;
+			if (!ReadFile(filename, file))
+			{
+				SDL_Log("Could not read sound (%s).", filename.c_str());
+				return;
+			}
+
+			// fmod copies the file data, the file can be released after the sound is created
+			FMOD_CREATESOUNDEXINFO info{};
+			info.cbsize = sizeof(info);
+			info.length = (unsigned int)file.GetSize();
+
 			FMOD::Sound* sound{ nullptr };
-			fmodSystem->createSound(filename.c_str(), FMOD_DEFAULT, 0, &sound);
-			sounds[string_tolower(name)] = sound;
+			fmodSystem->createSound(reinterpret_cast<const char*>(file.GetData()), FMOD_DEFAULT | FMOD_OPENMEMORY, &info, &sound);
+			sounds.Insert(id, sound);
 		}
 	}
 
-	AudioChannel AudioSystem::PlayAudio(const std::string& name, float volume, float pitch, bool loop)
+	AudioChannel AudioSystem::PlayAudio(ResourceId id, float volume, float pitch, bool loop)
 	{
-		auto iter = sounds.find(string_tolower(name));
-		if (iter != sounds.end())
+		FMOD::Sound** iter = sounds.Find(id);
+		if (iter != nullptr)
 		{
-			FMOD::Sound* sound = iter->second;
+			FMOD::Sound* sound = *iter;
 			sound->setMode(loop ? FMOD_LOOP_NORMAL : FMOD_LOOP_OFF);
 			FMOD::Channel* channel;
 			fmodSystem->playSound(sound, 0, true, &channel);
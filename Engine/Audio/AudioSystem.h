@@ -2,9 +2,9 @@
 
 #include "Framework/System.h"
 #include "Audio/AudioChannel.h"
+#include "Core/HashTable.h"
 #include <fmod.hpp>
 #include <string>
-#include <map>
 
 namespace nc
 {
@@ -17,11 +17,11 @@ namespace nc
 		void Update(float dt);
 
 		void AddAudio(const std::string& name, const std::string& filename);
-		AudioChannel PlayAudio(const std::string& name, float volume = 1, float pitch = 1, bool loop = false);
+		AudioChannel PlayAudio(ResourceId id, float volume = 1, float pitch = 1, bool loop = false);
 
 	private:
 		FMOD::System* fmodSystem;
-		std::map<std::string, FMOD::Sound*> sounds;
+		HashTable<FMOD::Sound*> sounds;
 	};
 }
 
@@ -15,7 +15,7 @@ namespace nc
 	void AudioComponent::Play()
 	{
 		channel.Stop();
-			channel = owner->scene->engine->Get<AudioSystem>()->PlayAudio(soundName, volume, pitch, loop);
+			channel = owner->scene->engine->Get<AudioSystem>()->PlayAudio(soundId, volume, pitch, loop);
 	}
 
 	void AudioComponent::Stop()
@@ -35,6 +35,7 @@ namespace nc
 		JSON_READ(value, pitch);
 		JSON_READ(value, loop);
 		JSON_READ(value, playOnAwake);
+		soundId = ResourceId{ soundName };
 
 			// add the audio to the audio system if there's a valid soundName string
 			if (soundName != "") owner->scene->engine->Get<AudioSystem>()->AddAudio(soundName, soundName);
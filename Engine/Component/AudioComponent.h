@@ -2,6 +2,7 @@
 
 #include "Component.h"
 #include "Audio/AudioChannel.h"
+#include "Resource/ResourceId.h"
 
 namespace nc
 {
@@ -26,6 +27,7 @@ namespace nc
 
 	private:
 		AudioChannel channel;
+		ResourceId soundId;
 		bool played{ false };
 	};
 }
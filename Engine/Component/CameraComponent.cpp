@@ -3,6 +3,23 @@
 
 namespace nc
 {
+	CameraComponent::~CameraComponent()
+	{
+		if (owner != nullptr && owner->scene != nullptr && owner->scene->GetActiveCamera() == this)
+		{
+			owner->scene->SetActiveCamera(nullptr);
+		}
+	}
+
+	void CameraComponent::Create()
+	{
+		// the first camera in the scene becomes the active camera
+		if (owner->scene != nullptr && owner->scene->GetActiveCamera() == nullptr)
+		{
+			owner->scene->SetActiveCamera(this);
+		}
+	}
+
 	void CameraComponent::Update()
 	{
 		glm::vec4 direction = owner->transform.matrix * glm::vec4{ 0, 0, -1, 0 };
@@ -14,6 +31,11 @@ namespace nc
 		projection = glm::perspective(glm::radians(fov), aspectRatio, near, far);
 	}
 
+	RenderQueue::frame_t CameraComponent::GetFrame() const
+	{
+		return { view, projection, projection * view };
+	}
+
 	bool CameraComponent::Write(const rapidjson::Value& value) const
 	{
 		return true;
@@ -1,5 +1,6 @@
 #pragma once
 #include "Component.h"
+#include "Graphics/RenderQueue.h"
 
 
 namespace nc
@@ -7,12 +8,18 @@ namespace nc
 	class CameraComponent : public Component
 	{
 	public:
+		virtual ~CameraComponent();
+
+		void Create() override;
+
 		virtual bool Write(const rapidjson::Value& value) const override;
 		virtual bool Read(const rapidjson::Value& value) override;
 
 		void Update() override;
 
 		void SetPerspective(float fov, float aspectRatio, float near, float far);
+		RenderQueue::frame_t GetFrame() const;
+		Frustum GetFrustum() const { return Frustum{ projection * view }; }
 
 	public:
 		glm::mat4 projection{ 1 };
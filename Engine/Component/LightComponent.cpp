@@ -10,25 +10,19 @@ namespace nc
 		glm::vec4 position{ 1 };
 
 		// transform the light position by the view, puts light in model view space
-		auto actor = owner->scene->FindActor("camera");
-		if (actor != nullptr)
+		auto camera = owner->scene->GetActiveCamera();
+		if (camera != nullptr)
 		{
-			position = actor->GetComponent<CameraComponent>()->view * glm::vec4{ owner->transform.position, 1 };
+			position = camera->view * glm::vec4{ owner->transform.position, 1 };
 		}
 
-		// get all shaders in the resource system
-		auto shaders = owner->scene->engine->Get<nc::ResourceSystem>()->Get<nc::Program>();
-		// set shaders light properties
-			for (auto& shader : shaders)
-			{
-				shader->SetUniform("light.ambient", ambient);
-				shader->SetUniform("light.diffuse", diffuse);
-				shader->SetUniform("light.specular", specular);
-				shader->SetUniform("light.position", position);
-
-				//<set light diffuse, specular, and position uniforms>
-			}
-
+		// light properties are uploaded once per frame in the lights uniform block
+		RenderQueue::light_t light;
+		light.position = position;
+		light.ambient = ambient;
+		light.diffuse = diffuse;
+		light.specular = specular;
+		owner->scene->engine->Get<Renderer>()->queue.SetLight(light);
 	}
 
 	bool LightComponent::Write(const rapidjson::Value& value) const
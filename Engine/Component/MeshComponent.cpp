@@ -11,16 +11,7 @@ namespace nc
 	
 	void MeshComponent::Draw(Renderer* renderer)
 	{
-		material->shader->SetUniform("model", owner->transform.matrix);
-		auto actor = owner->scene->FindActor("camera");
-		if (actor != nullptr)
-		{
-			material->shader->SetUniform("view", actor->GetComponent<CameraComponent>()->view);
-			material->shader->SetUniform("projection", actor->GetComponent<CameraComponent>()->projection);
-		}
-
-		material->Set();
-		vertexBuffer->Draw();
+		renderer->queue.Submit(material.get(), vertexBuffer.get(), owner->transform.matrix);
 	}
 
 
@@ -12,17 +12,10 @@ namespace nc
 
 	void ModelComponent::Draw(Renderer* renderer)
 	{
-		material->shader->Use();
-		material->shader->SetUniform("model", owner->transform.matrix);
-		auto actor = owner->scene->FindActor("camera");
-		if (actor != nullptr)
-		{
-			material->shader->SetUniform("view", actor->GetComponent<CameraComponent>()->view);
-			material->shader->SetUniform("projection", actor->GetComponent<CameraComponent>()->projection);
-		}
-
-		material->Set();
-		model->Draw();
+		// still loading
+		if (!model->IsReady()) return;
+
+		renderer->queue.Submit(material.get(), &model->vertexBuffer, owner->transform.matrix, model->bounds.Transform(owner->transform.matrix));
 	}
 
 	bool ModelComponent::Write(const rapidjson::Value& value) const
@@ -34,7 +27,11 @@ namespace nc
 	{
 		std::string model_name;
 		JSON_READ(value, model_name);
-		model = owner->scene->engine->Get<nc::ResourceSystem>()->Get<nc::Model>(model_name);
+		// optional compact vertex format
+		bool packed = false;
+		JSON_READ(value, packed);
+		Model::eVertexFormat format = (packed) ? Model::eVertexFormat::Packed : Model::eVertexFormat::Float;
+		model = owner->scene->engine->Get<nc::ResourceSystem>()->GetAsync<nc::Model>(model_name, reinterpret_cast<void*>(static_cast<std::uintptr_t>(format)));
 
 		std::string material_name;
 		JSON_READ(value, material_name);
@@ -0,0 +1,180 @@
+#include "Archive.h"
+#include "Lz4.h"
+#include <SDL.h>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+namespace nc
+{
+	namespace
+	{
+		const uint32_t ArchiveMagic = 0x4b50434e; // "NCPK"
+		const uint32_t ArchiveVersion = 1;
+		// file data alignment, suits gpu upload and keeps every entry on its own cache lines
+		const uint64_t Alignment = 256;
+
+		struct header_t
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t count;
+			uint64_t tocOffset;
+		};
+	}
+
+	bool Archive::Open(const std::string& filename)
+	{
+		Close();
+
+		if (!file.Open(filename)) return false;
+
+		header_t header;
+		if (file.GetSize() < sizeof(header))
+		{
+			Close();
+			return false;
+		}
+		std::memcpy(&header, file.GetData(), sizeof(header));
+
+		if (header.magic != ArchiveMagic || header.version != ArchiveVersion || header.tocOffset + header.count * sizeof(entry_t) > file.GetSize())
+		{
+			SDL_Log("Invalid archive (%s).", filename.c_str());
+			Close();
+			return false;
+		}
+
+		// the table of contents is 8 byte aligned in the mapping, read it in place
+		entries = reinterpret_cast<const entry_t*>(file.GetData() + header.tocOffset);
+		count = (size_t)header.count;
+
+		return true;
+	}
+
+	void Archive::Close()
+	{
+		file.Close();
+		entries = nullptr;
+		count = 0;
+	}
+
+	const Archive::entry_t* Archive::Find(const std::string& filename) const
+	{
+		if (count == 0) return nullptr;
+
+		uint64_t hash = ResourceId{ NormalizePath(filename) }.hash;
+		const entry_t* end = entries + count;
+		const entry_t* entry = std::lower_bound(entries, end, hash, [](const entry_t& entry, uint64_t hash) { return entry.hash < hash; });
+
+		return (entry != end && entry->hash == hash) ? entry : nullptr;
+	}
+
+	bool Archive::Read(const entry_t& entry, const uint8_t*& data, std::vector<uint8_t>& buffer) const
+	{
+		if (entry.offset + entry.storedSize > file.GetSize()) return false;
+
+		const uint8_t* stored = file.GetData() + entry.offset;
+		if (!(entry.flags & Compressed))
+		{
+			data = stored;
+			return true;
+		}
+
+		buffer.resize((size_t)entry.size);
+		if (!lz4::Decompress(stored, (size_t)entry.storedSize, buffer.data(), buffer.size())) return false;
+		data = buffer.data();
+
+		return true;
+	}
+
+	bool Archive::Build(const std::string& filename, const std::string& directory, bool compress)
+	{
+		std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			SDL_Log("Could not create archive (%s).", filename.c_str());
+			return false;
+		}
+
+		header_t header{ ArchiveMagic, ArchiveVersion, 0, 0 };
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		uint64_t offset = sizeof(header);
+
+		auto align = [&stream, &offset](uint64_t alignment)
+		{
+			static const char zeros[Alignment] = {};
+			uint64_t padding = (alignment - offset % alignment) % alignment;
+			stream.write(zeros, padding);
+			offset += padding;
+		};
+
+		std::vector<entry_t> toc;
+		std::vector<uint8_t> compressed;
+		std::error_code error;
+		for (auto& path : std::filesystem::recursive_directory_iterator(directory, error))
+		{
+			if (!path.is_regular_file()) continue;
+			// the archive itself may be written inside the packed directory
+			if (std::filesystem::equivalent(path.path(), filename, error)) continue;
+			// program binaries only work with the driver that wrote them
+			if (path.path().extension() == ".program") continue;
+
+			std::string name = std::filesystem::relative(path.path(), directory).generic_string();
+
+			std::ifstream input(path.path(), std::ios::binary);
+			std::vector<uint8_t> data{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+
+			entry_t entry{};
+			entry.hash = ResourceId{ NormalizePath(name) }.hash;
+			entry.size = data.size();
+
+			const uint8_t* stored = data.data();
+			entry.storedSize = data.size();
+			if (compress && !data.empty())
+			{
+				// keep the compressed data only if it saves at least 10%
+				compressed.resize(lz4::CompressBound(data.size()));
+				size_t size = lz4::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+				if (size && size * 10 <= data.size() * 9)
+				{
+					stored = compressed.data();
+					entry.storedSize = size;
+					entry.flags |= Compressed;
+				}
+			}
+
+			align(Alignment);
+			entry.offset = offset;
+			stream.write(reinterpret_cast<const char*>(stored), entry.storedSize);
+			offset += entry.storedSize;
+
+			toc.push_back(entry);
+		}
+
+		std::sort(toc.begin(), toc.end(), [](const entry_t& a, const entry_t& b) { return a.hash < b.hash; });
+		for (size_t i = 1; i < toc.size(); i++)
+		{
+			if (toc[i].hash == toc[i - 1].hash) SDL_Log("Archive path hash collision (%s).", filename.c_str());
+		}
+
+		align(sizeof(uint64_t));
+		header.count = toc.size();
+		header.tocOffset = offset;
+		stream.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(entry_t));
+
+		stream.seekp(0);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		return stream.good();
+	}
+
+	std::string Archive::NormalizePath(const std::string& filename)
+	{
+		std::string path = filename;
+		std::replace(path.begin(), path.end(), '\\', '/');
+		while (path.compare(0, 2, "./") == 0) path.erase(0, 2);
+
+		return path;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "FileSystem.h"
+#include "Resource/ResourceId.h"
+#include <string>
+#include <vector>
+
+namespace nc
+{
+	// read only packed file archive, the table of contents is sorted by the hashed path
+	// file data is aligned for direct upload and optionally lz4 compressed
+	class Archive
+	{
+	public:
+		struct entry_t
+		{
+			uint64_t hash;
+			uint64_t offset;
+			// size of the file and of the stored (compressed) data
+			uint64_t size;
+			uint64_t storedSize;
+			uint32_t flags;
+			uint32_t pad;
+		};
+
+		enum eFlags : uint32_t
+		{
+			Compressed = 1 << 0
+		};
+
+	public:
+		bool Open(const std::string& filename);
+		void Close();
+
+		const entry_t* Find(const std::string& filename) const;
+		// uncompressed entries point into the mapped archive, compressed entries are decompressed into buffer
+		bool Read(const entry_t& entry, const uint8_t*& data, std::vector<uint8_t>& buffer) const;
+
+		// pack every file under directory, paths are stored relative to it
+		static bool Build(const std::string& filename, const std::string& directory, bool compress = true);
+		// lookup form of a path: forward slashes without a leading ./ (the hash folds case)
+		static std::string NormalizePath(const std::string& filename);
+
+	private:
+		MappedFile file;
+		const entry_t* entries{ nullptr };
+		size_t count{ 0 };
+	};
+}
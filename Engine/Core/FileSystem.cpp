@@ -1,11 +1,28 @@
 #include "FileSystem.h"
+#include "Archive.h"
+#include <memory>
 #include <filesystem>
-#include <fstream>
-#include <sstream>
 #include <SDL.h>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace nc
 {
+	namespace
+	{
+		// mounted archives are opened at startup and only read afterwards, reads are safe from worker threads
+		std::vector<std::unique_ptr<Archive>> archives;
+	}
+
 	void SetFilePath(const std::string& pathname)
 	{
 		std::filesystem::current_path(pathname);
@@ -17,18 +34,154 @@ namespace nc
 
 	bool ReadFileToString(const std::string& filename, std::string& filestring)
 	{
-		std::ifstream fileStream(filename, std::ios::in);
-		if (!fileStream.is_open())
+		File file;
+		if (!ReadFile(filename, file))
 		{
 			SDL_Log("Error: Failed to open file: %s", filename.c_str());
 			return false;
 		}
 
-		std::stringstream stream;
-		stream << fileStream.rdbuf();
-		filestring = stream.str();
-		fileStream.close();
+		filestring.assign(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
 
 		return true;
 	}
+
+	bool MountArchive(const std::string& filename)
+	{
+		auto archive = std::make_unique<Archive>();
+		if (!archive->Open(filename)) return false;
+
+		archives.push_back(std::move(archive));
+
+		return true;
+	}
+
+	void UnmountArchives()
+	{
+		archives.clear();
+	}
+
+	bool ReadFile(const std::string& filename, File& file)
+	{
+		file.Close();
+
+		for (auto& archive : archives)
+		{
+			const Archive::entry_t* entry = archive->Find(filename);
+			if (entry == nullptr) continue;
+
+			if (!archive->Read(*entry, file.data, file.buffer))
+			{
+				SDL_Log("Could not read %s from archive.", filename.c_str());
+				return false;
+			}
+			file.size = (size_t)entry->size;
+
+			return true;
+		}
+
+		if (file.mapped.Open(filename))
+		{
+			file.data = file.mapped.GetData();
+			file.size = file.mapped.GetSize();
+
+			return true;
+		}
+
+		// empty files can not be mapped
+		std::error_code error;
+		return std::filesystem::is_regular_file(filename, error);
+	}
+
+	bool FileExists(const std::string& filename)
+	{
+		for (auto& archive : archives)
+		{
+			if (archive->Find(filename)) return true;
+		}
+
+		std::error_code error;
+		return std::filesystem::is_regular_file(filename, error);
+	}
+
+	void File::Close()
+	{
+		mapped.Close();
+		buffer.clear();
+		data = nullptr;
+		size = 0;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& filename)
+	{
+		Close();
+
+#ifdef _WIN32
+		// editors must be able to save or replace a file while a decode reads it, the watcher reloads it afterwards
+		HANDLE handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) return false;
+		file = handle;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+		size = (size_t)fileSize.QuadPart;
+
+		mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		file = open(filename.c_str(), O_RDONLY);
+		if (file == -1) return false;
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			Close();
+			return false;
+		}
+		size = (size_t)info.st_size;
+
+		void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		data = (view != MAP_FAILED) ? static_cast<const uint8_t*>(view) : nullptr;
+#endif
+
+		if (data == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file) CloseHandle(file);
+		mapping = nullptr;
+		file = nullptr;
+#else
+		if (data) munmap(const_cast<uint8_t*>(data), size);
+		if (file != -1) close(file);
+		file = -1;
+#endif
+		data = nullptr;
+		size = 0;
+	}
 }
@@ -1,9 +1,66 @@
 #pragma once
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
 
 namespace nc
 {
 	void SetFilePath(const std::string& pathname);
 	std::string GetFilePath();
 	bool ReadFileToString(const std::string& filename, std::string& filestring);
-}
\ No newline at end of file
+
+	// read only view of a whole file mapped into memory
+	class MappedFile
+	{
+	public:
+		MappedFile() {}
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator = (const MappedFile&) = delete;
+		~MappedFile();
+
+		bool Open(const std::string& filename);
+		void Close();
+
+		const uint8_t* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+
+	private:
+		const uint8_t* data{ nullptr };
+		size_t size{ 0 };
+#ifdef _WIN32
+		void* file{ nullptr };
+		void* mapping{ nullptr };
+#else
+		int file{ -1 };
+#endif
+	};
+
+	// contents of a file read through the virtual file system
+	// a view into a mounted archive, a decompressed copy or a mapped loose file
+	class File
+	{
+	public:
+		File() {}
+		File(const File&) = delete;
+		File& operator = (const File&) = delete;
+
+		const uint8_t* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+		void Close();
+
+	private:
+		friend bool ReadFile(const std::string& filename, File& file);
+
+		const uint8_t* data{ nullptr };
+		size_t size{ 0 };
+		std::vector<uint8_t> buffer;
+		MappedFile mapped;
+	};
+
+	// virtual file system, mounted archives are searched in mount order before loose files
+	bool MountArchive(const std::string& filename);
+	void UnmountArchives();
+	bool ReadFile(const std::string& filename, File& file);
+	bool FileExists(const std::string& filename);
+}
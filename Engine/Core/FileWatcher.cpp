@@ -0,0 +1,158 @@
+#include "FileWatcher.h"
+#include <SDL.h>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+namespace nc
+{
+	bool FileWatcher::Startup(const std::string& directory)
+	{
+		Shutdown();
+
+		std::error_code error;
+		this->directory = std::filesystem::absolute(directory, error);
+		if (error || !std::filesystem::is_directory(this->directory, error))
+		{
+			SDL_Log("Could not watch directory (%s).", directory.c_str());
+			return false;
+		}
+
+#ifdef __linux__
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd == -1)
+		{
+			SDL_Log("Could not create inotify instance.");
+			return false;
+		}
+
+		// inotify is not recursive, every directory gets its own watch
+		AddWatch(this->directory);
+		for (auto iter = std::filesystem::recursive_directory_iterator(this->directory, error); !error && iter != std::filesystem::recursive_directory_iterator(); iter.increment(error))
+		{
+			std::error_code ignored;
+			if (iter->is_directory(ignored)) AddWatch(iter->path());
+		}
+#else
+		// the first scan records the current write times
+		Scan(nullptr);
+		lastScan = std::chrono::steady_clock::now();
+#endif
+
+		watching = true;
+
+		return true;
+	}
+
+	void FileWatcher::Shutdown()
+	{
+#ifdef __linux__
+		if (fd != -1) close(fd);
+		fd = -1;
+		watches.clear();
+#else
+		times.clear();
+#endif
+		watching = false;
+	}
+
+	std::vector<std::string> FileWatcher::Poll()
+	{
+		std::vector<std::string> changed;
+		if (!watching) return changed;
+
+#ifdef __linux__
+		alignas(inotify_event) char buffer[4096];
+		for (;;)
+		{
+			ssize_t length = read(fd, buffer, sizeof(buffer));
+			if (length <= 0) break;
+
+			for (char* ptr = buffer; ptr < buffer + length;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+				ptr += sizeof(inotify_event) + event->len;
+
+				auto watch = watches.find(event->wd);
+				if (watch == watches.end()) continue;
+
+				if (event->mask & IN_IGNORED)
+				{
+					watches.erase(watch);
+					continue;
+				}
+				if (event->len == 0) continue;
+
+				std::filesystem::path path = watch->second / event->name;
+				if (event->mask & IN_ISDIR)
+				{
+					// new directories are watched, files written into them are reported from then on
+					if (event->mask & (IN_CREATE | IN_MOVED_TO)) AddWatch(path);
+				}
+				else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				{
+					// close write is only sent once the writer is done, editors that save by rename send moved to
+					changed.push_back(GetRelativePath(path));
+				}
+			}
+		}
+#else
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (std::chrono::duration<float>(now - lastScan).count() < interval) return changed;
+		lastScan = now;
+
+		Scan(&changed);
+#endif
+
+		// a save can write a file more than once
+		std::sort(changed.begin(), changed.end());
+		changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+		return changed;
+	}
+
+	std::string FileWatcher::GetRelativePath(const std::filesystem::path& path) const
+	{
+		return path.lexically_relative(directory).generic_string();
+	}
+
+#ifdef __linux__
+	void FileWatcher::AddWatch(const std::filesystem::path& path)
+	{
+		int wd = inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (wd == -1)
+		{
+			SDL_Log("Could not watch directory (%s).", path.c_str());
+			return;
+		}
+
+		watches[wd] = path;
+	}
+#else
+	void FileWatcher::Scan(std::vector<std::string>* changed)
+	{
+		std::error_code error;
+		for (auto iter = std::filesystem::recursive_directory_iterator(directory, error); !error && iter != std::filesystem::recursive_directory_iterator(); iter.increment(error))
+		{
+			std::error_code fileError;
+			if (!iter->is_regular_file(fileError)) continue;
+
+			std::filesystem::file_time_type time = iter->last_write_time(fileError);
+			if (fileError) continue;
+
+			// new files and files with a new write time are reported
+			std::string name = GetRelativePath(iter->path());
+			auto entry = times.find(name);
+			if (entry == times.end() || entry->second != time)
+			{
+				if (changed) changed->push_back(name);
+				times[name] = time;
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <filesystem>
+
+namespace nc
+{
+	// reports files written under a directory, paths are relative to the directory with forward slashes
+	// uses inotify on linux, other platforms compare file write times every poll interval
+	class FileWatcher
+	{
+	public:
+		FileWatcher() {}
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator = (const FileWatcher&) = delete;
+		~FileWatcher() { Shutdown(); }
+
+		bool Startup(const std::string& directory);
+		void Shutdown();
+
+		// files changed since the last poll, each file is reported once
+		std::vector<std::string> Poll();
+
+		bool IsWatching() const { return watching; }
+		void SetPollInterval(float seconds) { interval = seconds; }
+
+	private:
+		std::string GetRelativePath(const std::filesystem::path& path) const;
+
+	private:
+		std::filesystem::path directory;
+		bool watching{ false };
+		float interval{ 0.5f };
+
+#ifdef __linux__
+		void AddWatch(const std::filesystem::path& path);
+
+		int fd{ -1 };
+		// watched directory of each watch descriptor
+		std::map<int, std::filesystem::path> watches;
+#else
+		void Scan(std::vector<std::string>* changed);
+
+		std::map<std::string, std::filesystem::file_time_type> times;
+		std::chrono::steady_clock::time_point lastScan;
+#endif
+	};
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace nc
+{
+	// 64 bit fnv-1a, used by resource ids, vertex welding and content hashes
+	constexpr uint64_t HashOffset = 14695981039346656037ull;
+
+	constexpr uint64_t hash_byte(uint8_t byte, uint64_t hash = HashOffset)
+	{
+		return (hash ^ byte) * 1099511628211ull;
+	}
+
+	// pass the previous hash to continue hashing
+	inline uint64_t hash_bytes(const void* data, size_t size, uint64_t hash = HashOffset)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = hash_byte(bytes[i], hash);
+		}
+		return hash;
+	}
+}
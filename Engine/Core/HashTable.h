@@ -0,0 +1,158 @@
+#pragma once
+#include "Resource/ResourceId.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace nc
+{
+	// open addressing hash table keyed by a resource id, linear probing with tombstones
+	template<typename T>
+	class HashTable
+	{
+	public:
+		T* Find(ResourceId id);
+		const T* Find(ResourceId id) const;
+		// inserts or replaces the value of id
+		T& Insert(ResourceId id, T value);
+		bool Remove(ResourceId id);
+		void Clear();
+
+		size_t Size() const { return count; }
+
+		// function(ResourceId id, T& value)
+		template<typename F>
+		void ForEach(F function);
+
+	private:
+		enum class eState : uint8_t
+		{
+			Empty,
+			Used,
+			Removed
+		};
+
+		struct slot_t
+		{
+			ResourceId id;
+			T value{};
+			eState state{ eState::Empty };
+		};
+
+		// returns the slot holding id, or SIZE_MAX
+		size_t Lookup(ResourceId id) const;
+		void Grow();
+
+	private:
+		std::vector<slot_t> slots;
+		size_t count{ 0 };
+		// used and removed slots, the table grows when it is 70% full
+		size_t occupied{ 0 };
+	};
+
+	template<typename T>
+	inline T* HashTable<T>::Find(ResourceId id)
+	{
+		size_t index = Lookup(id);
+		return (index != SIZE_MAX) ? &slots[index].value : nullptr;
+	}
+
+	template<typename T>
+	inline const T* HashTable<T>::Find(ResourceId id) const
+	{
+		size_t index = Lookup(id);
+		return (index != SIZE_MAX) ? &slots[index].value : nullptr;
+	}
+
+	template<typename T>
+	inline T& HashTable<T>::Insert(ResourceId id, T value)
+	{
+		size_t index = Lookup(id);
+		if (index != SIZE_MAX)
+		{
+			slots[index].value = std::move(value);
+			return slots[index].value;
+		}
+
+		if ((occupied + 1) * 10 > slots.size() * 7) Grow();
+
+		// the hash is already well mixed, the low bits pick the slot
+		size_t mask = slots.size() - 1;
+		index = id.hash & mask;
+		while (slots[index].state == eState::Used) index = (index + 1) & mask;
+
+		if (slots[index].state == eState::Empty) occupied++;
+		count++;
+
+		slots[index].id = id;
+		slots[index].value = std::move(value);
+		slots[index].state = eState::Used;
+
+		return slots[index].value;
+	}
+
+	template<typename T>
+	inline bool HashTable<T>::Remove(ResourceId id)
+	{
+		size_t index = Lookup(id);
+		if (index == SIZE_MAX) return false;
+
+		// the slot stays occupied so later entries of the probe sequence are still found
+		slots[index].value = T{};
+		slots[index].state = eState::Removed;
+		count--;
+
+		return true;
+	}
+
+	template<typename T>
+	inline void HashTable<T>::Clear()
+	{
+		slots.clear();
+		count = 0;
+		occupied = 0;
+	}
+
+	template<typename T>
+	template<typename F>
+	inline void HashTable<T>::ForEach(F function)
+	{
+		for (auto& slot : slots)
+		{
+			if (slot.state == eState::Used) function(slot.id, slot.value);
+		}
+	}
+
+	template<typename T>
+	inline size_t HashTable<T>::Lookup(ResourceId id) const
+	{
+		if (slots.empty()) return SIZE_MAX;
+
+		size_t mask = slots.size() - 1;
+		for (size_t index = id.hash & mask;; index = (index + 1) & mask)
+		{
+			const slot_t& slot = slots[index];
+			if (slot.state == eState::Empty) return SIZE_MAX;
+			if (slot.state == eState::Used && slot.id == id) return index;
+		}
+	}
+
+	template<typename T>
+	inline void HashTable<T>::Grow()
+	{
+		std::vector<slot_t> old;
+		old.swap(slots);
+
+		// double when mostly used, rehash at the same size when mostly tombstones
+		size_t size = (old.empty()) ? 16 : old.size();
+		if (count * 2 >= size) size *= 2;
+		slots.resize(size);
+		count = 0;
+		occupied = 0;
+
+		for (auto& slot : old)
+		{
+			if (slot.state == eState::Used) Insert(slot.id, std::move(slot.value));
+		}
+	}
+}
@@ -1,7 +1,6 @@
 #include "Json.h"
 #include "Math/MathTypes.h"
-#include "istreamwrapper.h"
-#include <fstream>
+#include "Core/FileSystem.h"
 
 namespace nc
 {
@@ -9,17 +8,12 @@ namespace nc
 	{
 		bool Load(const std::string& filename, rapidjson::Document& document)
 		{
-			bool success = false;
+			File file;
+			if (!ReadFile(filename, file)) return false;
 
-			std::ifstream stream(filename);
-				if (stream.is_open())
-				{
-					rapidjson::IStreamWrapper istream(stream);
-					document.ParseStream(istream);
-					success = document.IsObject();
-				}
+			document.Parse(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
 
-			return success;
+			return document.IsObject();
 		}
 
 		bool Get(const rapidjson::Value& value, const std::string& name, int& data)
@@ -0,0 +1,172 @@
+#include "Lz4.h"
+#include <cstring>
+#include <vector>
+
+namespace nc
+{
+	namespace lz4
+	{
+		namespace
+		{
+			const size_t MinMatch = 4;
+			// the last match must start 12 bytes before the end and the last 5 bytes are always literals
+			const size_t MatchLimit = 12;
+			const size_t LastLiterals = 5;
+			const size_t MaxOffset = 65535;
+			const int HashBits = 12;
+
+			uint32_t Read32(const uint8_t* p)
+			{
+				uint32_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return value;
+			}
+
+			uint32_t Hash(uint32_t sequence)
+			{
+				return (sequence * 2654435761u) >> (32 - HashBits);
+			}
+
+			// writes the extra bytes of a length that does not fit in its token nibble
+			bool WriteLength(size_t length, uint8_t*& op, const uint8_t* end)
+			{
+				while (length >= 255)
+				{
+					if (op >= end) return false;
+					*op++ = 255;
+					length -= 255;
+				}
+				if (op >= end) return false;
+				*op++ = (uint8_t)length;
+
+				return true;
+			}
+
+			bool WriteSequence(const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength, uint8_t*& op, const uint8_t* end)
+			{
+				if (op >= end) return false;
+				uint8_t* token = op++;
+
+				*token = (uint8_t)(((literalLength >= 15) ? 15 : literalLength) << 4);
+				if (literalLength >= 15 && !WriteLength(literalLength - 15, op, end)) return false;
+
+				if ((size_t)(end - op) < literalLength) return false;
+				std::memcpy(op, literals, literalLength);
+				op += literalLength;
+
+				// the last sequence has no match
+				if (matchLength == 0) return true;
+
+				if (end - op < 2) return false;
+				*op++ = (uint8_t)(offset & 0xff);
+				*op++ = (uint8_t)(offset >> 8);
+
+				size_t length = matchLength - MinMatch;
+				*token |= (uint8_t)((length >= 15) ? 15 : length);
+				if (length >= 15 && !WriteLength(length - 15, op, end)) return false;
+
+				return true;
+			}
+
+			bool ReadLength(size_t& length, const uint8_t*& ip, const uint8_t* end)
+			{
+				uint8_t byte;
+				do
+				{
+					if (ip >= end) return false;
+					byte = *ip++;
+					length += byte;
+				} while (byte == 255);
+
+				return true;
+			}
+		}
+
+		size_t CompressBound(size_t size)
+		{
+			return size + size / 255 + 16;
+		}
+
+		size_t Compress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t capacity)
+		{
+			uint8_t* op = destination;
+			const uint8_t* end = destination + capacity;
+
+			// positions of the last occurrence of each hashed 4 byte sequence
+			std::vector<int64_t> table(size_t{ 1 } << HashBits, -1);
+
+			size_t anchor = 0;
+			size_t ip = 0;
+			if (sourceSize > MatchLimit)
+			{
+				size_t limit = sourceSize - MatchLimit;
+				while (ip <= limit)
+				{
+					uint32_t sequence = Read32(source + ip);
+					uint32_t hash = Hash(sequence);
+					int64_t candidate = table[hash];
+					table[hash] = (int64_t)ip;
+
+					if (candidate < 0 || ip - (size_t)candidate > MaxOffset || Read32(source + candidate) != sequence)
+					{
+						ip++;
+						continue;
+					}
+
+					size_t length = MinMatch;
+					size_t maxLength = sourceSize - LastLiterals - ip;
+					while (length < maxLength && source[ip + length] == source[candidate + length]) length++;
+
+					if (!WriteSequence(source + anchor, ip - anchor, ip - (size_t)candidate, length, op, end)) return 0;
+
+					ip += length;
+					anchor = ip;
+				}
+			}
+
+			if (!WriteSequence(source + anchor, sourceSize - anchor, 0, 0, op, end)) return 0;
+
+			return op - destination;
+		}
+
+		bool Decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize)
+		{
+			const uint8_t* ip = source;
+			const uint8_t* ipEnd = source + sourceSize;
+			uint8_t* op = destination;
+			uint8_t* opEnd = destination + destinationSize;
+
+			while (ip < ipEnd)
+			{
+				uint8_t token = *ip++;
+
+				size_t literalLength = token >> 4;
+				if (literalLength == 15 && !ReadLength(literalLength, ip, ipEnd)) return false;
+				if ((size_t)(ipEnd - ip) < literalLength || (size_t)(opEnd - op) < literalLength) return false;
+				std::memcpy(op, ip, literalLength);
+				ip += literalLength;
+				op += literalLength;
+
+				// the last sequence ends after its literals
+				if (ip == ipEnd) break;
+
+				if (ipEnd - ip < 2) return false;
+				size_t offset = ip[0] | (ip[1] << 8);
+				ip += 2;
+				if (offset == 0 || offset > (size_t)(op - destination)) return false;
+
+				size_t matchLength = token & 0xf;
+				if (matchLength == 15 && !ReadLength(matchLength, ip, ipEnd)) return false;
+				matchLength += MinMatch;
+				if ((size_t)(opEnd - op) < matchLength) return false;
+
+				// matches may overlap their own output, copy forward byte by byte
+				const uint8_t* match = op - offset;
+				for (size_t i = 0; i < matchLength; i++) op[i] = match[i];
+				op += matchLength;
+			}
+
+			return op == opEnd;
+		}
+	}
+}
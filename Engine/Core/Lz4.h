@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace nc
+{
+	// lz4 block format, compatible with the reference LZ4_compress_default / LZ4_decompress_safe
+	namespace lz4
+	{
+		// worst case compressed size of size bytes
+		size_t CompressBound(size_t size);
+		// returns the compressed size, 0 if it does not fit in capacity
+		size_t Compress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t capacity);
+		// destinationSize is the exact decompressed size, returns false on corrupt data
+		bool Decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize);
+	}
+}
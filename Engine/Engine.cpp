@@ -13,6 +13,9 @@ namespace nc
 
 		std::for_each(systems.begin(), systems.end(), [](auto& system) { system->Startup(); });
 
+		// streamed textures report their memory use as their levels change
+		Get<Renderer>()->streamer.SetResourceSystem(Get<ResourceSystem>());
+
 		REGISTER_CLASS(Actor)
 		REGISTER_CLASS(PhysicsComponent)
 		REGISTER_CLASS(AudioComponent)
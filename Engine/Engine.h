@@ -10,6 +10,7 @@
 // Core
 #include "Core/Utilities.h"
 #include "Core/FileSystem.h"
+#include "Core/Archive.h"
 #include "Core/Timer.h"
 #include "Core/Json.h"
 #include "Core/Serializable.h"
@@ -28,6 +29,7 @@
 //Graphics
 #include "Graphics/Renderer.h"
 #include "Graphics/Texture.h"
+#include "Graphics/TextureBaker.h"
 #include "Graphics/Material.h"
 #include "Graphics/Shader.h"
 #include "Graphics/Program.h"
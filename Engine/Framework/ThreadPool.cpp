@@ -0,0 +1,53 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace nc
+{
+	void ThreadPool::Startup(size_t count)
+	{
+		if (count == 0)
+		{
+			unsigned int hardware = std::thread::hardware_concurrency();
+			count = (hardware > 1) ? hardware - 1 : 1;
+		}
+
+		stop = false;
+		for (size_t i = 0; i < count; i++)
+		{
+			threads.emplace_back(&ThreadPool::Run, this);
+		}
+	}
+
+	void ThreadPool::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition.notify_all();
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		threads.clear();
+	}
+
+	void ThreadPool::Run()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this]() { return stop || !tasks.empty(); });
+				if (stop && tasks.empty()) return;
+
+				task = std::move(tasks.front());
+				tasks.pop();
+			}
+
+			task();
+		}
+	}
+}
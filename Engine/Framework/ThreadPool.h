@@ -0,0 +1,66 @@
+#pragma once
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace nc
+{
+	class ThreadPool
+	{
+	public:
+		ThreadPool() {}
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator = (const ThreadPool&) = delete;
+		~ThreadPool() { Shutdown(); }
+
+		// 0 uses one thread per hardware thread, leaving one for the main thread
+		void Startup(size_t count = 0);
+		// queued tasks are finished before the threads are joined
+		void Shutdown();
+
+		template<typename F>
+		auto Enqueue(F function) -> std::future<decltype(function())>;
+
+		size_t GetThreadCount() const { return threads.size(); }
+
+	private:
+		void Run();
+
+	private:
+		std::vector<std::thread> threads;
+		std::queue<std::function<void()>> tasks;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool stop{ false };
+	};
+
+	template<typename F>
+	inline auto ThreadPool::Enqueue(F function) -> std::future<decltype(function())>
+	{
+		using result_t = decltype(function());
+
+		// std::function must be copyable, share the packaged task
+		auto task = std::make_shared<std::packaged_task<result_t()>>(std::move(function));
+		std::future<result_t> future = task->get_future();
+
+		// without threads the task runs on the caller
+		if (threads.empty())
+		{
+			(*task)();
+			return future;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push([task]() { (*task)(); });
+		}
+		condition.notify_one();
+
+		return future;
+	}
+}
@@ -0,0 +1,237 @@
+#include "Dds.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace nc
+{
+	namespace dds
+	{
+		namespace
+		{
+			constexpr uint32_t FourCC(char a, char b, char c, char d)
+			{
+				return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+			}
+
+			const uint32_t Magic = FourCC('D', 'D', 'S', ' ');
+			// written into the first reserved header word of baked files, which are stored bottom row first
+			const uint32_t BakedTag = FourCC('N', 'C', 'B', 'K');
+
+			// header flags
+			const uint32_t Caps = 0x1;
+			const uint32_t Height = 0x2;
+			const uint32_t Width = 0x4;
+			const uint32_t PixelFormat = 0x1000;
+			const uint32_t MipMapCount = 0x20000;
+			const uint32_t LinearSize = 0x80000;
+			// pixel format flags
+			const uint32_t FourCCFlag = 0x4;
+			// caps
+			const uint32_t CapsComplex = 0x8;
+			const uint32_t CapsTexture = 0x1000;
+			const uint32_t CapsMipMap = 0x400000;
+
+			// dxgi formats of the dx10 header extension
+			const uint32_t DxgiBC1 = 71;
+			const uint32_t DxgiBC1Srgb = 72;
+			const uint32_t DxgiBC3 = 77;
+			const uint32_t DxgiBC3Srgb = 78;
+			const uint32_t DxgiBC5 = 83;
+			const uint32_t DxgiBC7 = 98;
+			const uint32_t DxgiBC7Srgb = 99;
+
+			struct pixel_format_t
+			{
+				uint32_t size;
+				uint32_t flags;
+				uint32_t fourCC;
+				uint32_t rgbBitCount;
+				uint32_t rBitMask;
+				uint32_t gBitMask;
+				uint32_t bBitMask;
+				uint32_t aBitMask;
+			};
+
+			struct header_t
+			{
+				uint32_t size;
+				uint32_t flags;
+				uint32_t height;
+				uint32_t width;
+				uint32_t pitchOrLinearSize;
+				uint32_t depth;
+				uint32_t mipMapCount;
+				uint32_t reserved1[11];
+				pixel_format_t pixelFormat;
+				uint32_t caps;
+				uint32_t caps2;
+				uint32_t caps3;
+				uint32_t caps4;
+				uint32_t reserved2;
+			};
+
+			struct header_dx10_t
+			{
+				uint32_t dxgiFormat;
+				uint32_t resourceDimension;
+				uint32_t miscFlag;
+				uint32_t arraySize;
+				uint32_t miscFlags2;
+			};
+
+			static_assert(sizeof(header_t) == 124, "dds header is 124 bytes");
+
+			GLenum GetFormat(uint32_t fourCC)
+			{
+				switch (fourCC)
+				{
+				case FourCC('D', 'X', 'T', '1'): return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+				case FourCC('D', 'X', 'T', '5'): return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+				case FourCC('A', 'T', 'I', '2'):
+				case FourCC('B', 'C', '5', 'U'): return GL_COMPRESSED_RG_RGTC2;
+				}
+				return 0;
+			}
+
+			GLenum GetDxgiFormat(uint32_t dxgiFormat)
+			{
+				switch (dxgiFormat)
+				{
+				case DxgiBC1:
+				case DxgiBC1Srgb: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+				case DxgiBC3:
+				case DxgiBC3Srgb: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+				case DxgiBC5: return GL_COMPRESSED_RG_RGTC2;
+				case DxgiBC7:
+				case DxgiBC7Srgb: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+				}
+				return 0;
+			}
+
+			uint32_t GetFourCC(GLenum format)
+			{
+				switch (format)
+				{
+				case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+				case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return FourCC('D', 'X', 'T', '1');
+				case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return FourCC('D', 'X', 'T', '5');
+				case GL_COMPRESSED_RG_RGTC2: return FourCC('A', 'T', 'I', '2');
+				}
+				return 0;
+			}
+		}
+
+		size_t GetBlockSize(GLenum format)
+		{
+			return (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
+		}
+
+		size_t GetLevelSize(GLenum format, int width, int height)
+		{
+			return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+		}
+
+		bool Read(const uint8_t* data, size_t size, image_t& image)
+		{
+			if (size < sizeof(uint32_t) + sizeof(header_t)) return false;
+
+			uint32_t magic;
+			std::memcpy(&magic, data, sizeof(magic));
+			if (magic != Magic) return false;
+
+			header_t header;
+			std::memcpy(&header, data + sizeof(magic), sizeof(header));
+			size_t offset = sizeof(magic) + sizeof(header);
+
+			if (header.pixelFormat.flags & FourCCFlag)
+			{
+				if (header.pixelFormat.fourCC == FourCC('D', 'X', '1', '0'))
+				{
+					if (size < offset + sizeof(header_dx10_t)) return false;
+					header_dx10_t header10;
+					std::memcpy(&header10, data + offset, sizeof(header10));
+					offset += sizeof(header10);
+					image.format = GetDxgiFormat(header10.dxgiFormat);
+				}
+				else
+				{
+					image.format = GetFormat(header.pixelFormat.fourCC);
+				}
+			}
+			if (image.format == 0)
+			{
+				SDL_Log("Unsupported dds format.");
+				return false;
+			}
+
+			// other tools store the top row first, their blocks would have to be flipped
+			if (header.reserved1[0] != BakedTag)
+			{
+				SDL_Log("Dds file was not baked by the engine.");
+				return false;
+			}
+
+			image.width = (int)header.width;
+			image.height = (int)header.height;
+			image.levels.clear();
+			if (image.width <= 0 || image.height <= 0) return false;
+
+			// a count past the 1x1 level would make the texture storage fail
+			uint32_t chain = 1;
+			for (int size = std::max(image.width, image.height); size > 1; size /= 2) chain++;
+			uint32_t count = (header.flags & MipMapCount) ? std::min(std::max(header.mipMapCount, 1u), chain) : 1;
+			int width = image.width;
+			int height = image.height;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				size_t levelSize = GetLevelSize(image.format, width, height);
+				if (offset + levelSize > size) return false;
+
+				image.levels.push_back({ data + offset, levelSize, width, height });
+				offset += levelSize;
+
+				width = std::max(width / 2, 1);
+				height = std::max(height / 2, 1);
+			}
+
+			return true;
+		}
+
+		bool Write(const std::string& filename, GLenum format, int width, int height, const std::vector<std::vector<uint8_t>>& levels)
+		{
+			uint32_t fourCC = GetFourCC(format);
+			if (fourCC == 0 || levels.empty()) return false;
+
+			header_t header{};
+			header.size = sizeof(header_t);
+			header.flags = Caps | Height | Width | PixelFormat | MipMapCount | LinearSize;
+			header.height = (uint32_t)height;
+			header.width = (uint32_t)width;
+			header.pitchOrLinearSize = (uint32_t)levels[0].size();
+			header.mipMapCount = (uint32_t)levels.size();
+			header.reserved1[0] = BakedTag;
+			header.pixelFormat.size = sizeof(pixel_format_t);
+			header.pixelFormat.flags = FourCCFlag;
+			header.pixelFormat.fourCC = fourCC;
+			header.caps = CapsTexture | ((levels.size() > 1) ? (CapsComplex | CapsMipMap) : 0);
+
+			std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+			if (!stream.is_open())
+			{
+				SDL_Log("Could not write dds file (%s).", filename.c_str());
+				return false;
+			}
+
+			stream.write(reinterpret_cast<const char*>(&Magic), sizeof(Magic));
+			stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			for (auto& level : levels)
+			{
+				stream.write(reinterpret_cast<const char*>(level.data()), level.size());
+			}
+
+			return stream.good();
+		}
+	}
+}
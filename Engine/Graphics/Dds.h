@@ -0,0 +1,48 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// GL_EXT_texture_compression_s3tc, glad is generated without extensions
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace nc
+{
+	// dds files holding block compressed textures (bc1, bc3, bc5 and bc7)
+	// only files baked by the engine (TextureBaker) are read, they are stored bottom row first as the textures are uploaded
+	namespace dds
+	{
+		struct level_t
+		{
+			const uint8_t* data;
+			size_t size;
+			int width;
+			int height;
+		};
+
+		struct image_t
+		{
+			GLenum format{ 0 };
+			int width{ 0 };
+			int height{ 0 };
+			// every mip level in the file, largest first
+			std::vector<level_t> levels;
+		};
+
+		// 4x4 blocks of 8 (bc1) or 16 bytes
+		size_t GetBlockSize(GLenum format);
+		size_t GetLevelSize(GLenum format, int width, int height);
+
+		// the levels point into data, which has to outlive the image
+		// files without the baked tag are rejected, the mip count is clamped to the levels down to 1x1
+		bool Read(const uint8_t* data, size_t size, image_t& image);
+		bool Write(const std::string& filename, GLenum format, int width, int height, const std::vector<std::vector<uint8_t>>& levels);
+	}
+}
@@ -22,20 +22,58 @@ namespace nc
 		JSON_READ(document, specular);
 		JSON_READ(document, shininess);
 
+		// textures
+		std::vector<std::string> texture_names;
+		JSON_READ(document, texture_names);
+
 		// program
 		std::string shader_name;
 		JSON_READ(document, shader_name);
-		shader = engine->Get<ResourceSystem>()->Get<Program>(shader_name, engine);
+		// optional program that reads the model matrix per instance
+		std::string instanced_shader_name;
+		JSON_READ(document, instanced_shader_name);
 
-		// textures
-		std::vector<std::string> texture_names;
-		JSON_READ(document, texture_names);
+		// an uber shader is compiled with the features the material uses, the textures are color then normal map
+		std::string uber_shader;
+		JSON_READ(document, uber_shader);
+		if (!uber_shader.empty())
+		{
+			bool fog = false;
+			JSON_READ(document, fog);
+
+			features = 0;
+			if (texture_names.size() > 0) features |= Program::DiffuseMap;
+			if (texture_names.size() > 1) features |= Program::NormalMap;
+			if (fog) features |= Program::Fog;
+
+			shader_name = Program::GetVariantName(uber_shader, features);
+			instanced_shader_name = Program::GetVariantName(uber_shader, features | Program::Instanced);
+		}
+
+		// the names are only copied by the resource system when it loads them
+		ResourceSystem* resourceSystem = engine->Get<ResourceSystem>();
+		shader = resourceSystem->Get<Program>(ResourceId{ shader_name }, shader_name, engine);
+		uniforms = GetUniforms(shader.get());
+
+		instancedShader.reset();
+		instancedUniforms = uniforms_t{};
+		if (!instanced_shader_name.empty())
+		{
+			instancedShader = resourceSystem->Get<Program>(ResourceId{ instanced_shader_name }, instanced_shader_name, engine);
+			instancedUniforms = GetUniforms(instancedShader.get());
+		}
+		// a reload replaces the textures
+		textures.clear();
 
 		GLuint units[] = { GL_TEXTURE0, GL_TEXTURE1, GL_TEXTURE2, GL_TEXTURE3, GL_TEXTURE4, GL_TEXTURE5 };
 		size_t i = 0;
 		for (auto& name : texture_names)
 		{
-			auto texture = engine->Get<ResourceSystem>()->Get<Texture>(name, (void*)units[i++]);
+			// decoded in the background, the texture is bound as empty until it is uploaded
+			// the second texture is the normal map, its mips are filtered without gamma
+			GLuint data = (i == 1) ? (units[i] | Texture::Linear) : units[i];
+			i++;
+			auto texture = resourceSystem->GetAsync<Texture>(ResourceId{ name }, name, (void*)(std::uintptr_t)data);
 			if (texture.get()) // check for valid texture
 			{
 				AddTexture(texture);
@@ -45,13 +83,36 @@ namespace nc
 	}
 
 	void Material::Set()
+	{
+		Set(shader.get(), uniforms);
+	}
+
+	void Material::SetInstanced()
+	{
+		Set(instancedShader.get(), instancedUniforms);
+	}
+
+	Material::uniforms_t Material::GetUniforms(Program* program)
+	{
+		uniforms_t uniforms;
+		if (program != nullptr)
+		{
+			uniforms.diffuse = program->GetUniformHandle("material.diffuse");
+			uniforms.specular = program->GetUniformHandle("material.specular");
+			uniforms.shininess = program->GetUniformHandle("material.shininess");
+		}
+
+		return uniforms;
+	}
+
+	void Material::Set(Program* program, const uniforms_t& uniforms)
 	{
 		// set the shader (bind)
-		shader->Use();
+		program->Use();
 		// update shader material properties
-		shader->SetUniform("material.diffuse", diffuse);
-		shader->SetUniform("material.specular", specular);
-		shader->SetUniform("material.shininess", shininess);
+		program->SetUniform(uniforms.diffuse, diffuse);
+		program->SetUniform(uniforms.specular, specular);
+		program->SetUniform(uniforms.shininess, shininess);
 
 		// set the textures (bind)
 		// maybe try using std::for_each
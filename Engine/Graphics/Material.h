@@ -7,10 +7,14 @@ namespace nc
 	struct Material : public Resource
 	{
 	public:
+		Material() : id{ ++count } {}
+
 		bool Load(const std::string& filename, void* data = nullptr) override;
+		bool CanReload() const override { return true; }
 
 		void Set();
-		void SetShader(const std::shared_ptr<Program>& shader) { this->shader = shader; }
+		void SetInstanced();
+		void SetShader(const std::shared_ptr<Program>& shader) { this->shader = shader; uniforms = GetUniforms(shader.get()); }
 		void AddTexture(const std::shared_ptr<Texture>& texture) { textures.push_back(texture); }
 
 	public:
@@ -19,6 +23,31 @@ namespace nc
 		float shininess = 100.0f;
 
 		std::shared_ptr<Program> shader;
+		std::shared_ptr<Program> instancedShader;
 		std::vector<std::shared_ptr<Texture>> textures;
+		// uber shader features of the programs (Program::eFeature)
+		uint32_t features = 0;
+
+		// unique id used to group draws by material
+		const uint32_t id;
+
+	private:
+		// uniform handles of the material properties for one program
+		struct uniforms_t
+		{
+			GLint diffuse = -1;
+			GLint specular = -1;
+			GLint shininess = -1;
+		};
+
+		static uniforms_t GetUniforms(Program* program);
+		void Set(Program* program, const uniforms_t& uniforms);
+
+	private:
+		uniforms_t uniforms;
+		uniforms_t instancedUniforms;
+
+	private:
+		static inline uint32_t count = 0;
 	};
 }
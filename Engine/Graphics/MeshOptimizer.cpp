@@ -0,0 +1,332 @@
+#include "MeshOptimizer.h"
+#include "Core/Hash.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <cmath>
+
+namespace nc
+{
+	namespace
+	{
+		// forsyth scoring constants
+		const int CacheSize = 32;
+		const float LastTriangleScore = 0.75f;
+		const float CacheDecayPower = 1.5f;
+		const float ValenceBoostScale = 2.0f;
+		const float ValenceBoostPower = -0.5f;
+
+		float VertexScore(int cachePosition, uint32_t valence)
+		{
+			// no triangles left to draw with this vertex
+			if (valence == 0) return -1.0f;
+
+			float score = 0;
+			if (cachePosition >= 0)
+			{
+				// the vertices of the last triangle get a fixed score so the next triangle does not favor one of them
+				if (cachePosition < 3) score = LastTriangleScore;
+				else score = std::pow(1.0f - (cachePosition - 3) / (float)(CacheSize - 3), CacheDecayPower);
+			}
+
+			// favor vertices with few triangles left so they are not left behind
+			score += ValenceBoostScale * std::pow((float)valence, ValenceBoostPower);
+
+			return score;
+		}
+
+		uint64_t HashVertex(const uint8_t* vertex, size_t vertexSize)
+		{
+			return hash_bytes(vertex, vertexSize);
+		}
+	}
+
+	MeshOptimizer::stats_t& MeshOptimizer::stats_t::operator += (const stats_t& other)
+	{
+		triangles += other.triangles;
+		vertices += other.vertices;
+		misses += other.misses;
+
+		return *this;
+	}
+
+	size_t MeshOptimizer::WeldVertices(void* vertices, size_t vertexCount, size_t vertexSize, GLuint* indices, size_t indexCount)
+	{
+		uint8_t* data = static_cast<uint8_t*>(vertices);
+
+		// open addressing table of unique vertex indices, power of two sized and at most half full
+		size_t tableSize = 1;
+		while (tableSize < vertexCount * 2) tableSize *= 2;
+		const GLuint empty = ~0u;
+		std::vector<GLuint> table(tableSize, empty);
+
+		std::vector<GLuint> remap(vertexCount);
+		size_t unique = 0;
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const uint8_t* vertex = data + i * vertexSize;
+
+			size_t slot = HashVertex(vertex, vertexSize) & (tableSize - 1);
+			while (table[slot] != empty && std::memcmp(data + table[slot] * vertexSize, vertex, vertexSize) != 0)
+			{
+				slot = (slot + 1) & (tableSize - 1);
+			}
+
+			if (table[slot] == empty)
+			{
+				// unique vertices are compacted to the front, the write never passes the read
+				if (unique != i) std::memmove(data + unique * vertexSize, vertex, vertexSize);
+				table[slot] = (GLuint)unique;
+				unique++;
+			}
+
+			remap[i] = table[slot];
+		}
+
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			indices[i] = remap[indices[i]];
+		}
+
+		return unique;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) return;
+
+		std::vector<GLuint> source{ indices, indices + indexCount };
+
+		// triangles adjacent to each vertex, the first valence entries are the ones not yet drawn
+		std::vector<uint32_t> valence(vertexCount, 0);
+		for (GLuint index : source) valence[index]++;
+
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < vertexCount; i++) offsets[i + 1] = offsets[i] + valence[i];
+
+		std::vector<uint32_t> adjacency(indexCount);
+		std::vector<uint32_t> fill{ offsets.begin(), offsets.end() - 1 };
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			adjacency[fill[source[i]]++] = (uint32_t)(i / 3);
+		}
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++) vertexScore[i] = VertexScore(-1, valence[i]);
+
+		std::vector<float> triangleScore(triangleCount);
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		int best = 0;
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			triangleScore[i] = vertexScore[source[i * 3 + 0]] + vertexScore[source[i * 3 + 1]] + vertexScore[source[i * 3 + 2]];
+			if (triangleScore[i] > triangleScore[best]) best = (int)i;
+		}
+
+		std::vector<GLuint> cache;
+		std::vector<GLuint> nextCache;
+		size_t cursor = 0;
+		size_t output = 0;
+
+		while (best >= 0)
+		{
+			const GLuint* triangle = &source[best * 3];
+			emitted[best] = 1;
+			for (int i = 0; i < 3; i++) indices[output++] = triangle[i];
+
+			// remove the triangle from the adjacency of its vertices
+			for (int i = 0; i < 3; i++)
+			{
+				GLuint vertex = triangle[i];
+				uint32_t* triangles = &adjacency[offsets[vertex]];
+				for (uint32_t j = 0; j < valence[vertex]; j++)
+				{
+					if (triangles[j] == (uint32_t)best)
+					{
+						triangles[j] = triangles[valence[vertex] - 1];
+						break;
+					}
+				}
+				valence[vertex]--;
+			}
+
+			// the drawn triangle moves to the front of the lru cache
+			nextCache.assign(triangle, triangle + 3);
+			for (GLuint vertex : cache)
+			{
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) nextCache.push_back(vertex);
+			}
+
+			// rescore the cached and evicted vertices
+			for (size_t i = 0; i < nextCache.size(); i++)
+			{
+				GLuint vertex = nextCache[i];
+				cachePosition[vertex] = (i < (size_t)CacheSize) ? (int)i : -1;
+				vertexScore[vertex] = VertexScore(cachePosition[vertex], valence[vertex]);
+			}
+
+			// the next triangle is the best one touching the cache
+			best = -1;
+			float bestScore = -1;
+			for (GLuint vertex : nextCache)
+			{
+				for (uint32_t j = 0; j < valence[vertex]; j++)
+				{
+					uint32_t t = adjacency[offsets[vertex] + j];
+					const GLuint* other = &source[t * 3];
+					triangleScore[t] = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+					if (triangleScore[t] > bestScore)
+					{
+						bestScore = triangleScore[t];
+						best = (int)t;
+					}
+				}
+			}
+
+			if (nextCache.size() > (size_t)CacheSize) nextCache.resize(CacheSize);
+			cache.swap(nextCache);
+
+			// nothing in the cache has triangles left, continue with the next triangle not drawn
+			if (best < 0)
+			{
+				while (cursor < triangleCount && emitted[cursor]) cursor++;
+				if (cursor < triangleCount) best = (int)cursor;
+			}
+		}
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(GLuint* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) return;
+
+		auto position = [&](GLuint index)
+		{
+			const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + index * positionStride);
+			return glm::vec3{ p[0], p[1], p[2] };
+		};
+
+		// split the cache optimized order where the cache starts over (every vertex of a triangle misses)
+		// reordering whole clusters keeps the vertex cache efficiency
+		const size_t FifoSize = 16;
+		std::vector<size_t> timestamps(vertexCount, 0);
+		size_t time = FifoSize + 1;
+
+		std::vector<size_t> clusters;
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			int misses = 0;
+			for (int j = 0; j < 3; j++)
+			{
+				GLuint vertex = indices[i * 3 + j];
+				if (time - timestamps[vertex] > FifoSize)
+				{
+					timestamps[vertex] = time++;
+					misses++;
+				}
+			}
+
+			if (i == 0 || misses == 3) clusters.push_back(i);
+		}
+		if (clusters.size() < 2) return;
+
+		glm::vec3 meshCentroid{ 0 };
+		for (size_t i = 0; i < indexCount; i++) meshCentroid += position(indices[i]);
+		meshCentroid /= (float)indexCount;
+
+		// sort key is how far the cluster faces away from the mesh center, outer clusters occlude the inner ones
+		struct cluster_t
+		{
+			size_t first;
+			size_t count;
+			float key;
+		};
+		std::vector<cluster_t> order;
+		for (size_t i = 0; i < clusters.size(); i++)
+		{
+			cluster_t cluster;
+			cluster.first = clusters[i];
+			cluster.count = ((i + 1 < clusters.size()) ? clusters[i + 1] : triangleCount) - cluster.first;
+
+			glm::vec3 normal{ 0 };
+			glm::vec3 centroid{ 0 };
+			float area = 0;
+			for (size_t t = cluster.first; t < cluster.first + cluster.count; t++)
+			{
+				glm::vec3 p0 = position(indices[t * 3 + 0]);
+				glm::vec3 p1 = position(indices[t * 3 + 1]);
+				glm::vec3 p2 = position(indices[t * 3 + 2]);
+
+				// the cross product length is twice the area, weight the normal and centroid by it
+				glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+				float a = glm::length(n);
+				normal += n;
+				centroid += (p0 + p1 + p2) * (a / 3.0f);
+				area += a;
+			}
+
+			centroid = (area > 0) ? centroid / area : position(indices[cluster.first * 3]);
+			float length = glm::length(normal);
+			cluster.key = (length > 0) ? glm::dot(centroid - meshCentroid, normal / length) : 0;
+
+			order.push_back(cluster);
+		}
+
+		std::stable_sort(order.begin(), order.end(), [](const cluster_t& a, const cluster_t& b) { return a.key > b.key; });
+
+		std::vector<GLuint> source{ indices, indices + indexCount };
+		size_t output = 0;
+		for (auto& cluster : order)
+		{
+			std::memcpy(indices + output, &source[cluster.first * 3], cluster.count * 3 * sizeof(GLuint));
+			output += cluster.count * 3;
+		}
+	}
+
+	size_t MeshOptimizer::OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, GLuint* indices, size_t indexCount)
+	{
+		const GLuint unused = ~0u;
+		std::vector<GLuint> remap(vertexCount, unused);
+
+		size_t next = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			GLuint& index = remap[indices[i]];
+			if (index == unused) index = (GLuint)next++;
+			indices[i] = index;
+		}
+
+		uint8_t* data = static_cast<uint8_t*>(vertices);
+		std::vector<uint8_t> source{ data, data + vertexCount * vertexSize };
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			if (remap[i] != unused) std::memcpy(data + remap[i] * vertexSize, &source[i * vertexSize], vertexSize);
+		}
+
+		return next;
+	}
+
+	MeshOptimizer::stats_t MeshOptimizer::AnalyzeVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+	{
+		stats_t stats;
+		stats.triangles = indexCount / 3;
+		stats.vertices = vertexCount;
+
+		std::vector<size_t> timestamps(vertexCount, 0);
+		size_t time = cacheSize + 1;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			GLuint vertex = indices[i];
+			if (time - timestamps[vertex] > cacheSize)
+			{
+				timestamps[vertex] = time++;
+				stats.misses++;
+			}
+		}
+
+		return stats;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace nc
+{
+	// import time optimization of indexed triangle lists, every pass works in place
+	class MeshOptimizer
+	{
+	public:
+		struct stats_t
+		{
+			size_t triangles{ 0 };
+			size_t vertices{ 0 };
+			size_t misses{ 0 };
+
+			// average cache miss ratio (transformed vertices per triangle), 0.5 is the best case
+			float ACMR() const { return (triangles) ? misses / (float)triangles : 0; }
+			// average transform to vertex ratio, 1.0 means every vertex is transformed once
+			float ATVR() const { return (vertices) ? misses / (float)vertices : 0; }
+
+			stats_t& operator += (const stats_t& other);
+		};
+
+	public:
+		// merge identical vertices and rewrite the indices, returns the new vertex count
+		static size_t WeldVertices(void* vertices, size_t vertexCount, size_t vertexSize, GLuint* indices, size_t indexCount);
+		// reorder triangles for the post transform vertex cache (Forsyth)
+		static void OptimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount);
+		// reorder the cache friendly clusters of triangles so outward facing clusters are drawn first
+		static void OptimizeOverdraw(GLuint* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount);
+		// reorder vertices in the order they are first referenced, returns the number of referenced vertices
+		static size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, GLuint* indices, size_t indexCount);
+
+		// simulate a fifo vertex cache
+		static stats_t AnalyzeVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = 16);
+	};
+}
@@ -1,11 +1,80 @@
 #include "Model.h"
+#include "MeshOptimizer.h"
+#include <glm/gtc/packing.hpp>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <cmath>
 
 namespace nc
 {
+	namespace
+	{
+		// increment when the cache layout or the import processing changes
+		const uint32_t CacheMagic = 0x434d434e; // "NCMC"
+		const uint32_t CacheVersion = 6;
+
+		// vertices addressable by a 16 bit index relative to the submesh base vertex
+		const size_t MaxShortIndexVertices = 65536;
+
+		struct cache_header_t
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t format;
+			uint32_t vertexSize;
+			uint32_t indexSize;
+			uint64_t sourceSize;
+			int64_t sourceTime;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t submeshCount;
+			glm::vec3 boundsMin;
+			glm::vec3 boundsMax;
+			glm::vec3 sphereCenter;
+			float sphereRadius;
+			float texcoordDensity;
+		};
+
+		std::string GetCacheName(const std::string& name, Model::eVertexFormat format)
+		{
+			return name + ((format == Model::eVertexFormat::Packed) ? ".packed.mesh" : ".mesh");
+		}
+
+		bool GetSourceStamp(const std::string& name, uint64_t& size, int64_t& time)
+		{
+			std::error_code error;
+			size = std::filesystem::file_size(name, error);
+			if (error) return false;
+			time = std::filesystem::last_write_time(name, error).time_since_epoch().count();
+			return !error;
+		}
+	}
+
 	bool Model::Load(const std::string& name, void* data)
 	{
+		return Decode(name, data) && Upload(name, data);
+	}
+
+	bool Model::Decode(const std::string& name, void* data)
+	{
+		format = static_cast<eVertexFormat>(reinterpret_cast<std::uintptr_t>(data));
+
+		if (ReadCache(name)) return true;
+
+		File file;
+		if (!ReadFile(name, file))
+		{
+			SDL_Log("Could not read model (%s).", name.c_str());
+			return false;
+		}
+
+		// the extension tells assimp the format of the data
+		std::string extension = std::filesystem::path{ name }.extension().string();
+		if (!extension.empty()) extension.erase(0, 1);
+
 		Assimp::Importer importer;
-		const aiScene* scene = importer.ReadFile(name, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+		const aiScene* scene = importer.ReadFileFromMemory(file.GetData(), file.GetSize(), aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace, extension.c_str());
 
 		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 		{
@@ -13,11 +82,61 @@ namespace nc
 			return false;
 		}
 
+		// size the merged arrays once
+		size_t totalVertices = 0;
+		size_t totalIndices = 0;
+		for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+		{
+			totalVertices += scene->mMeshes[i]->mNumVertices;
+			totalIndices += (size_t)scene->mMeshes[i]->mNumFaces * 3;
+		}
+		vertices.reserve(totalVertices);
+		indices.reserve(totalIndices);
+
 		ProcessNode(scene->mRootNode, scene);
+		Optimize(name);
+		SplitSubmeshes();
+		CalculateBounds();
+		CalculateTexcoordDensity();
+		if (format == eVertexFormat::Packed) PackVertices();
+
+		WriteCache(name);
+
+		vertexData = (format == eVertexFormat::Packed) ? (const void*)packedVertices.data() : (const void*)vertices.data();
+		indexData = (indexType == GL_UNSIGNED_SHORT) ? (const void*)shortIndices.data() : (const void*)indices.data();
+		vertexCount = vertices.size();
+		indexCount = indices.size();
 
 		return true;
 	}
 
+	bool Model::Upload(const std::string& name, void* data)
+	{
+		if (vertexData == nullptr) return false;
+
+		CreateBuffers(vertexData, vertexCount, indexData, indexCount, submeshes);
+		vertexBuffer.SetTexcoordDensity(texcoordDensity);
+
+		// the gpu has the data now
+		cache.Close();
+		vertexData = nullptr;
+		indexData = nullptr;
+		vertices = std::vector<vertex_t>{};
+		packedVertices = std::vector<packed_vertex_t>{};
+		indices = std::vector<GLuint>{};
+		shortIndices = std::vector<GLushort>{};
+		submeshes.clear();
+
+		return true;
+	}
+
+	size_t Model::GetCpuBytes() const
+	{
+		// only the cpu copies still waiting for upload
+		return vertices.capacity() * sizeof(vertex_t) + packedVertices.capacity() * sizeof(packed_vertex_t) +
+			indices.capacity() * sizeof(GLuint) + shortIndices.capacity() * sizeof(GLushort) + cache.GetSize();
+	}
+
 	void Model::Draw(GLenum primitiveType)
 	{
 		vertexBuffer.Draw(primitiveType);
@@ -40,7 +159,10 @@ namespace nc
 
 	void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
 	{
-		std::vector<vertex_t> vertices;
+		VertexBuffer::submesh_t submesh;
+		submesh.baseVertex = (GLint)vertices.size();
+		submesh.firstIndex = (GLuint)indices.size();
+		submesh.materialIndex = mesh->mMaterialIndex;
 
 		// get model vertex attributes
 		for (size_t i = 0; i < mesh->mNumVertices; i++)
@@ -49,7 +171,11 @@ namespace nc
 
 			vertex.position = { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z };
 			vertex.normal = { mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z };
-			vertex.tangent = { mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z };
+			vertex.tangent = { mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z, 1 };
+
+			// the shaders rebuild the bitangent as cross(normal, tangent), keep the sign of the imported one
+			glm::vec3 bitangent{ mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z };
+			if (glm::dot(glm::cross(vertex.normal, glm::vec3{ vertex.tangent }), bitangent) < 0) vertex.tangent.w = -1;
 
 			if (mesh->mTextureCoords[0])
 			{
@@ -63,15 +189,7 @@ namespace nc
 			vertices.push_back(vertex);
 		}
 
-		// create vertex buffer and attributes
-		vertexBuffer.CreateVertexBuffer((GLsizei)(sizeof(vertex_t) * vertices.size()), (GLsizei)vertices.size(), vertices.data());
-		vertexBuffer.SetAttribute(0, 3, sizeof(vertex_t), 0);
-		vertexBuffer.SetAttribute(1, 3, sizeof(vertex_t), offsetof(vertex_t, normal));
-		vertexBuffer.SetAttribute(2, 2, sizeof(vertex_t), offsetof(vertex_t, texcoord));
-		vertexBuffer.SetAttribute(3, 3, sizeof(vertex_t), offsetof(vertex_t, tangent));
-
-		// get model index vertices
-		std::vector<GLuint> indices;
+		// get model index vertices, relative to the submesh base vertex
 		for (size_t i = 0; i < mesh->mNumFaces; i++)
 		{
 			aiFace face = mesh->mFaces[i];
@@ -81,7 +199,291 @@ namespace nc
 			}
 		}
 
+		submesh.indexCount = (GLsizei)(indices.size() - submesh.firstIndex);
+		submeshes.push_back(submesh);
+	}
+
+	void Model::Optimize(const std::string& name)
+	{
+		MeshOptimizer::stats_t before;
+		MeshOptimizer::stats_t after;
+
+		// welding shrinks each submesh, compact them toward the front as they are processed
+		size_t vertexOffset = 0;
+		for (size_t i = 0; i < submeshes.size(); i++)
+		{
+			VertexBuffer::submesh_t& submesh = submeshes[i];
+			size_t vertexEnd = (i + 1 < submeshes.size()) ? submeshes[i + 1].baseVertex : vertices.size();
+			size_t vertexCount = vertexEnd - submesh.baseVertex;
+			GLuint* meshIndices = indices.data() + submesh.firstIndex;
+
+			if (vertexOffset != (size_t)submesh.baseVertex)
+			{
+				std::memmove(&vertices[vertexOffset], &vertices[submesh.baseVertex], vertexCount * sizeof(vertex_t));
+			}
+			submesh.baseVertex = (GLint)vertexOffset;
+			vertex_t* meshVertices = &vertices[vertexOffset];
+
+			before += MeshOptimizer::AnalyzeVertexCache(meshIndices, submesh.indexCount, vertexCount);
+
+			vertexCount = MeshOptimizer::WeldVertices(meshVertices, vertexCount, sizeof(vertex_t), meshIndices, submesh.indexCount);
+			MeshOptimizer::OptimizeVertexCache(meshIndices, submesh.indexCount, vertexCount);
+			MeshOptimizer::OptimizeOverdraw(meshIndices, submesh.indexCount, &meshVertices->position.x, sizeof(vertex_t), vertexCount);
+			vertexCount = MeshOptimizer::OptimizeVertexFetch(meshVertices, vertexCount, sizeof(vertex_t), meshIndices, submesh.indexCount);
+
+			after += MeshOptimizer::AnalyzeVertexCache(meshIndices, submesh.indexCount, vertexCount);
+
+			vertexOffset += vertexCount;
+		}
+		vertices.resize(vertexOffset);
+
+		SDL_Log("%s: acmr %.3f -> %.3f, atvr %.3f -> %.3f, vertices %zu -> %zu", name.c_str(), before.ACMR(), after.ACMR(), before.ATVR(), after.ATVR(), before.vertices, after.vertices);
+	}
+
+	void Model::SplitSubmeshes()
+	{
+		bool split = false;
+		for (size_t i = 0; i < submeshes.size(); i++)
+		{
+			size_t vertexEnd = (i + 1 < submeshes.size()) ? submeshes[i + 1].baseVertex : vertices.size();
+			if (vertexEnd - submeshes[i].baseVertex > MaxShortIndexVertices) split = true;
+		}
+
+		if (split)
+		{
+			std::vector<vertex_t> splitVertices;
+			std::vector<GLuint> splitIndices;
+			std::vector<VertexBuffer::submesh_t> splitSubmeshes;
+			splitVertices.reserve(vertices.size());
+			splitIndices.reserve(indices.size());
+
+			for (size_t i = 0; i < submeshes.size(); i++)
+			{
+				const VertexBuffer::submesh_t& submesh = submeshes[i];
+				size_t vertexEnd = (i + 1 < submeshes.size()) ? submeshes[i + 1].baseVertex : vertices.size();
+				size_t vertexCount = vertexEnd - submesh.baseVertex;
+
+				// walk the triangles in their optimized order, start a new chunk when the next triangle does not fit
+				// vertices used on both sides of a chunk boundary are duplicated
+				const GLuint unused = ~0u;
+				std::vector<GLuint> remap(vertexCount, unused);
+				std::vector<GLuint> remapped;
+
+				VertexBuffer::submesh_t chunk;
+				auto begin = [&]()
+				{
+					chunk = submesh;
+					chunk.baseVertex = (GLint)splitVertices.size();
+					chunk.firstIndex = (GLuint)splitIndices.size();
+					chunk.indexCount = 0;
+				};
+				begin();
+
+				for (GLsizei t = 0; t < submesh.indexCount; t += 3)
+				{
+					const GLuint* triangle = &indices[submesh.firstIndex + t];
+
+					size_t added = 0;
+					for (int j = 0; j < 3; j++) added += (remap[triangle[j]] == unused);
+					if (splitVertices.size() - chunk.baseVertex + added > MaxShortIndexVertices)
+					{
+						splitSubmeshes.push_back(chunk);
+						for (GLuint vertex : remapped) remap[vertex] = unused;
+						remapped.clear();
+						begin();
+					}
+
+					for (int j = 0; j < 3; j++)
+					{
+						GLuint vertex = triangle[j];
+						if (remap[vertex] == unused)
+						{
+							remap[vertex] = (GLuint)(splitVertices.size() - chunk.baseVertex);
+							remapped.push_back(vertex);
+							splitVertices.push_back(vertices[submesh.baseVertex + vertex]);
+						}
+						splitIndices.push_back(remap[vertex]);
+					}
+					chunk.indexCount += 3;
+				}
+				splitSubmeshes.push_back(chunk);
+			}
+
+			vertices.swap(splitVertices);
+			indices.swap(splitIndices);
+			submeshes.swap(splitSubmeshes);
+		}
+
+		// every submesh now fits in 16 bit indices, half the index memory
+		indexType = GL_UNSIGNED_SHORT;
+		shortIndices.assign(indices.begin(), indices.end());
+	}
+
+	void Model::CalculateBounds()
+	{
+		bounds = AABB{};
+		for (auto& vertex : vertices)
+		{
+			bounds.Expand(vertex.position);
+		}
+
+		// bounding sphere around the box center, tighter than the sphere around the box
+		sphere = Sphere{ bounds.Center(), 0 };
+		for (auto& vertex : vertices)
+		{
+			sphere.radius = glm::max(sphere.radius, glm::distance(sphere.center, vertex.position));
+		}
+	}
+
+	void Model::CalculateTexcoordDensity()
+	{
+		// square root of the texcoord area over the surface area, the scale from model units to texcoord units
+		double area = 0;
+		double texcoordArea = 0;
+		for (const VertexBuffer::submesh_t& submesh : submeshes)
+		{
+			for (GLsizei i = 0; i + 2 < submesh.indexCount; i += 3)
+			{
+				const GLuint* triangle = &indices[submesh.firstIndex + i];
+				const vertex_t& v0 = vertices[submesh.baseVertex + triangle[0]];
+				const vertex_t& v1 = vertices[submesh.baseVertex + triangle[1]];
+				const vertex_t& v2 = vertices[submesh.baseVertex + triangle[2]];
+
+				area += glm::length(glm::cross(v1.position - v0.position, v2.position - v0.position));
+				glm::vec2 e1 = v1.texcoord - v0.texcoord;
+				glm::vec2 e2 = v2.texcoord - v0.texcoord;
+				texcoordArea += std::abs(e1.x * e2.y - e1.y * e2.x);
+			}
+		}
+
+		texcoordDensity = (area > 0 && texcoordArea > 0) ? (float)std::sqrt(texcoordArea / area) : 1.0f;
+	}
+
+	void Model::PackVertices()
+	{
+		packedVertices.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const vertex_t& vertex = vertices[i];
+			packed_vertex_t& packed = packedVertices[i];
+
+			uint64_t position = glm::packHalf4x16(glm::vec4{ vertex.position, 1 });
+			std::memcpy(packed.position, &position, sizeof(packed.position));
+			packed.normal = glm::packSnorm3x10_1x2(glm::vec4{ vertex.normal, 0 });
+			packed.tangent = glm::packSnorm3x10_1x2(vertex.tangent);
+			uint32_t texcoord = glm::packHalf2x16(vertex.texcoord);
+			std::memcpy(packed.texcoord, &texcoord, sizeof(packed.texcoord));
+		}
+	}
+
+	void Model::CreateBuffers(const void* vertices, size_t vertexCount, const void* indices, size_t indexCount, const std::vector<VertexBuffer::submesh_t>& submeshes)
+	{
+		// create vertex buffer and attributes
+		GLsizei stride = (GLsizei)GetVertexSize();
+		vertexBuffer.CreateVertexBuffer((GLsizei)(stride * vertexCount), (GLsizei)vertexCount, (void*)vertices);
+		if (format == eVertexFormat::Packed)
+		{
+			vertexBuffer.SetAttribute(0, 3, stride, offsetof(packed_vertex_t, position), GL_HALF_FLOAT);
+			vertexBuffer.SetAttribute(1, 4, stride, offsetof(packed_vertex_t, normal), GL_INT_2_10_10_10_REV, GL_TRUE);
+			vertexBuffer.SetAttribute(2, 2, stride, offsetof(packed_vertex_t, texcoord), GL_HALF_FLOAT);
+			vertexBuffer.SetAttribute(3, 4, stride, offsetof(packed_vertex_t, tangent), GL_INT_2_10_10_10_REV, GL_TRUE);
+		}
+		else
+		{
+			vertexBuffer.SetAttribute(0, 3, stride, 0);
+			vertexBuffer.SetAttribute(1, 3, stride, offsetof(vertex_t, normal));
+			vertexBuffer.SetAttribute(2, 2, stride, offsetof(vertex_t, texcoord));
+			vertexBuffer.SetAttribute(3, 4, stride, offsetof(vertex_t, tangent));
+		}
+
 		// create index vertex buffer
-		vertexBuffer.CreateIndexBuffer(GL_UNSIGNED_INT, (GLsizei)indices.size(), indices.data());
+		vertexBuffer.CreateIndexBuffer(indexType, (GLsizei)indexCount, (void*)indices);
+		vertexBuffer.SetSubmeshes(submeshes);
+	}
+
+	bool Model::ReadCache(const std::string& name)
+	{
+		uint64_t sourceSize = 0;
+		int64_t sourceTime = 0;
+		bool hasSource = GetSourceStamp(name, sourceSize, sourceTime);
+
+		// read through the file system so a cache packed in an archive is used in place
+		File& file = cache;
+		if (!ReadFile(GetCacheName(name, format), file)) return false;
+		if (file.GetSize() < sizeof(cache_header_t))
+		{
+			file.Close();
+			return false;
+		}
+
+		cache_header_t header;
+		std::memcpy(&header, file.GetData(), sizeof(header));
+
+		bool valid = (header.magic == CacheMagic && header.version == CacheVersion && header.format == (uint32_t)format && header.vertexSize == GetVertexSize() && (header.indexSize == sizeof(GLushort) || header.indexSize == sizeof(GLuint)));
+		// a cache without its source is still used, a cache older than its source is not
+		if (hasSource && (header.sourceSize != sourceSize || header.sourceTime != sourceTime)) valid = false;
+		if (!valid)
+		{
+			file.Close();
+			return false;
+		}
+
+		size_t vertexBytes = (size_t)header.vertexCount * GetVertexSize();
+		indexType = (header.indexSize == sizeof(GLushort)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		size_t indexBytes = (size_t)header.indexCount * GetIndexSize();
+		size_t submeshBytes = (size_t)header.submeshCount * sizeof(VertexBuffer::submesh_t);
+		if (file.GetSize() < sizeof(header) + vertexBytes + indexBytes + submeshBytes)
+		{
+			file.Close();
+			return false;
+		}
+
+		bounds = AABB{ header.boundsMin, header.boundsMax };
+		sphere = Sphere{ header.sphereCenter, header.sphereRadius };
+		texcoordDensity = header.texcoordDensity;
+
+		// the upload reads straight from the mapped file
+		const uint8_t* data = file.GetData() + sizeof(header);
+		submeshes.resize(header.submeshCount);
+		std::memcpy(submeshes.data(), data + vertexBytes + indexBytes, submeshBytes);
+		vertexData = data;
+		indexData = data + vertexBytes;
+		vertexCount = header.vertexCount;
+		indexCount = header.indexCount;
+
+		return true;
+	}
+
+	void Model::WriteCache(const std::string& name)
+	{
+		cache_header_t header{};
+		header.magic = CacheMagic;
+		header.version = CacheVersion;
+		header.format = (uint32_t)format;
+		header.vertexSize = (uint32_t)GetVertexSize();
+		header.indexSize = (uint32_t)GetIndexSize();
+		GetSourceStamp(name, header.sourceSize, header.sourceTime);
+		header.vertexCount = (uint32_t)vertices.size();
+		header.indexCount = (uint32_t)indices.size();
+		header.submeshCount = (uint32_t)submeshes.size();
+		header.boundsMin = bounds.min;
+		header.boundsMax = bounds.max;
+		header.sphereCenter = sphere.center;
+		header.sphereRadius = sphere.radius;
+		header.texcoordDensity = texcoordDensity;
+
+		std::ofstream stream(GetCacheName(name, format), std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			SDL_Log("Could not write mesh cache (%s).", GetCacheName(name, format).c_str());
+			return;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		const void* vertexData = (format == eVertexFormat::Packed) ? (const void*)packedVertices.data() : (const void*)vertices.data();
+		stream.write(reinterpret_cast<const char*>(vertexData), vertices.size() * GetVertexSize());
+		const void* indexData = (indexType == GL_UNSIGNED_SHORT) ? (const void*)shortIndices.data() : (const void*)indices.data();
+		stream.write(reinterpret_cast<const char*>(indexData), indices.size() * GetIndexSize());
+		stream.write(reinterpret_cast<const char*>(submeshes.data()), submeshes.size() * sizeof(VertexBuffer::submesh_t));
 	}
 }
@@ -2,6 +2,8 @@
 #include "Renderer.h"
 #include "VertexBuffer.h"
 #include "Texture.h"
+#include "Math/Bounds.h"
+#include "Core/FileSystem.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -12,25 +14,87 @@ namespace nc
 	class Model : public Resource
 	{
 	public:
+		enum class eVertexFormat : uint32_t
+		{
+			Float,
+			// half float position and texcoord, 10:10:10:2 normal and tangent
+			Packed
+		};
+
 		struct vertex_t
 		{
 			glm::vec3 position;
 			glm::vec3 normal;
 			glm::vec2 texcoord;
-			glm::vec3 tangent;
+			// w is the bitangent sign
+			glm::vec4 tangent;
+		};
+
+		// 20 bytes instead of 48, decoded by the vertex fetch so the shaders read the same attributes
+		struct packed_vertex_t
+		{
+			uint16_t position[4];
+			uint32_t normal;
+			uint32_t tangent;
+			uint16_t texcoord[2];
 		};
 
 	public:
 		~Model() {}
 
+		// data is the eVertexFormat, the format of the first load is kept for the shared resource
 		bool Load(const std::string& name, void* data) override;
+		// import or cache read on a worker thread, buffer creation on the render thread
+		bool Decode(const std::string& name, void* data) override;
+		bool Upload(const std::string& name, void* data) override;
+
+		size_t GetGpuBytes() const override { return vertexBuffer.GetGpuBytes(); }
+		size_t GetCpuBytes() const override;
 		void Draw(GLenum primitiveType = GL_TRIANGLES);
 
 	private:
 		void ProcessNode(aiNode* node, const aiScene* scene);
 		void ProcessMesh(aiMesh* mesh, const aiScene* scene);
+		// weld and reorder each submesh for the vertex cache, overdraw and vertex fetch
+		void Optimize(const std::string& name);
+		// split submeshes too large for 16 bit indices into chunks, then narrow the indices
+		void SplitSubmeshes();
+		void CalculateBounds();
+		void CalculateTexcoordDensity();
+		void PackVertices();
+		size_t GetVertexSize() const { return (format == eVertexFormat::Packed) ? sizeof(packed_vertex_t) : sizeof(vertex_t); }
+		size_t GetIndexSize() const { return (indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint); }
+		void CreateBuffers(const void* vertices, size_t vertexCount, const void* indices, size_t indexCount, const std::vector<VertexBuffer::submesh_t>& submeshes);
+
+		// baked vertex and index data, skips the assimp import when the source has not changed
+		bool ReadCache(const std::string& name);
+		void WriteCache(const std::string& name);
 
 	public:
 		VertexBuffer vertexBuffer;
+		eVertexFormat format{ eVertexFormat::Float };
+
+		// model space bounds computed at load
+		AABB bounds;
+		Sphere sphere;
+		// average texcoord units per model space unit
+		float texcoordDensity{ 1 };
+
+	private:
+		// decoded data waiting for upload, points into the cache file or the arrays below
+		File cache;
+		const void* vertexData{ nullptr };
+		const void* indexData{ nullptr };
+		size_t vertexCount{ 0 };
+		size_t indexCount{ 0 };
+
+		// cpu copies of the imported data, released after upload
+		// every mesh is appended to the same arrays and recorded as a submesh
+		std::vector<vertex_t> vertices;
+		std::vector<packed_vertex_t> packedVertices;
+		std::vector<GLuint> indices;
+		std::vector<GLushort> shortIndices;
+		std::vector<VertexBuffer::submesh_t> submeshes;
+		GLenum indexType{ GL_UNSIGNED_INT };
 	};
 }
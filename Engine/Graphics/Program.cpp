@@ -1,11 +1,79 @@
 #include "Program.h"
 #include "Engine.h"
+#include "Core/Hash.h"
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
 
 namespace nc
 {
+	namespace
+	{
+		// increment when the cache layout changes
+		const uint32_t BinaryMagic = 0x4250434e; // "NCPB"
+		const uint32_t BinaryVersion = 1;
+
+		struct binary_header_t
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t format;
+			uint32_t size;
+			uint64_t key;
+		};
+
+		// binaries are driver specific, they live in the user cache directory and never in the resources or an archive
+		// an empty name disables the cache
+		std::string GetBinaryName(const std::string& name)
+		{
+			static const std::string directory = []()
+			{
+				std::string directory;
+				if (char* path = SDL_GetPrefPath("nc", "engine"))
+				{
+					directory = std::string{ path } + "programs";
+					SDL_free(path);
+
+					std::error_code error;
+					std::filesystem::create_directories(directory, error);
+					if (error) directory.clear();
+				}
+				return directory;
+			}();
+			if (directory.empty()) return std::string{};
+
+			// one flat directory, the key in the header tells apart names that flatten the same
+			std::string flat = name;
+			std::replace_if(flat.begin(), flat.end(), [](char c) { return c == '/' || c == '\\' || c == ':'; }, '_');
+			return directory + "/" + flat + ".program";
+		}
+
+		const char* FeatureDefines[] = { "DIFFUSE_MAP", "NORMAL_MAP", "INSTANCED", "FOG" };
+
+		// define list appended to the shader names of a variant, #DIFFUSE_MAP,FOG
+		std::string GetDefines(uint32_t features)
+		{
+			std::string defines;
+			for (size_t i = 0; i < sizeof(FeatureDefines) / sizeof(FeatureDefines[0]); i++)
+			{
+				if (!(features & (1u << i))) continue;
+				defines += (defines.empty()) ? "#" : ",";
+				defines += FeatureDefines[i];
+			}
+			return defines;
+		}
+
+		bool IsBinarySupported()
+		{
+			GLint formats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			return formats > 0;
+		}
+	}
+
 	Program::Program()
 	{
-		program = glCreateProgram();
 	}
 
 	Program::~Program()
@@ -13,50 +81,71 @@ namespace nc
 		if (program != 0)
 		{
 			// delete program
-			glDeleteProgram(program);
+			Renderer::state.DeleteProgram(program);
 		}
+		if (linking.program != 0) glDeleteProgram(linking.program);
 	}
 
 	bool Program::Load(const std::string& filename, void* data)
 	{
 		auto engine = (Engine*)data;
 
+		// a variant carries its feature bits after the file name
+		size_t separator = filename.find('#');
+		std::string file = filename.substr(0, separator);
+		uint32_t features = (separator != std::string::npos) ? (uint32_t)std::strtoul(filename.c_str() + separator + 1, nullptr, 10) : 0;
+		std::string defines = GetDefines(features);
+
 		rapidjson::Document document;
-		bool success = nc::json::Load(filename, document);
+		bool success = nc::json::Load(file, document);
 		if (!success)
 		{
-			SDL_Log("Could not load shader file (%s).", filename.c_str());
+			SDL_Log("Could not load shader file (%s).", file.c_str());
 			return false;
 		}
 
+		std::vector<std::shared_ptr<Shader>> shaders;
+		dependencies.clear();
+		// a variant is not the resource of its file, it reloads with the file
+		if (separator != std::string::npos) dependencies.push_back(file);
+
 		std::string vertex_shader;
 		JSON_READ(document, vertex_shader);
 		if (!vertex_shader.empty())
 		{
-			auto vshader = engine->Get<nc::ResourceSystem>()->Get<nc::Shader>(vertex_shader, (void*)GL_VERTEX_SHADER);
-			AddShader(vshader);
+			shaders.push_back(engine->Get<nc::ResourceSystem>()->Get<nc::Shader>(vertex_shader + defines, (void*)GL_VERTEX_SHADER));
+			dependencies.push_back(vertex_shader + defines);
 		}
 
 		std::string fragment_shader;
 		JSON_READ(document, fragment_shader);
-			if (!fragment_shader.empty())
-			{
-				auto fshader = engine->Get<nc::ResourceSystem>()->Get<nc::Shader>(fragment_shader, (void*)GL_FRAGMENT_SHADER);
-				AddShader(fshader);
-			}
+		if (!fragment_shader.empty())
+		{
+			shaders.push_back(engine->Get<nc::ResourceSystem>()->Get<nc::Shader>(fragment_shader + defines, (void*)GL_FRAGMENT_SHADER));
+			dependencies.push_back(fragment_shader + defines);
+		}
 
-		Link();
-		Use();
+		// the link is only submitted, its status is read when the program is first used (Resolve)
+		// a reload keeps the program in use until the new one links
+		return Build(filename, shaders);
+	}
 
-		return true;
+	bool Program::DependsOn(ResourceId id) const
+	{
+		return std::find(dependencies.begin(), dependencies.end(), id) != dependencies.end();
+	}
 
+	std::string Program::GetVariantName(const std::string& name, uint32_t features)
+	{
+		return (features) ? name + "#" + std::to_string(features) : name;
 	}
 
 	void Program::AddShader(const std::shared_ptr<Shader>& shader)
 	{
+		if (program == 0) program = glCreateProgram();
 		shaders.push_back(shader);
 
-		glAttachShader(program, shader->shader);
+		glAttachShader(program, shader->Compile());
 	}
 
 	void Program::Link()
@@ -67,6 +156,186 @@ namespace nc
 		glLinkProgram(program);
 
 		// check program link status
+		if (!CheckLinkStatus(program))
+		{
+			Renderer::state.DeleteProgram(program);
+			program = 0;
+		}
+		else
+		{
+			linked = true;
+			ReflectUniforms();
+#ifdef _DEBUG
+			DisplayInfo();
+#endif
+		}
+	}
+
+	bool Program::Build(const std::string& filename, const std::vector<std::shared_ptr<Shader>>& shaders)
+	{
+		// a newer build replaces one that has not been resolved yet
+		if (linking.program != 0) glDeleteProgram(linking.program);
+		linking = link_t{};
+		linking.shaders = shaders;
+
+		// the cache is keyed by the shader sources and the driver, anything else compiles from source
+		bool useBinary = IsBinarySupported();
+		uint64_t key = GetBinaryKey(shaders);
+		if (useBinary)
+		{
+			linking.program = ReadBinary(GetBinaryName(filename), key);
+			if (linking.program != 0) return true;
+		}
+
+		// compiles and the link are queued without reading their status so the driver can overlap them
+		linking.program = glCreateProgram();
+		for (auto& shader : shaders)
+		{
+			glAttachShader(linking.program, shader->Compile());
+		}
+
+		// the binary can only be read back if requested before linking
+		if (useBinary)
+		{
+			glProgramParameteri(linking.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			linking.binaryName = GetBinaryName(filename);
+			linking.key = key;
+		}
+		glLinkProgram(linking.program);
+
+		return true;
+	}
+
+	void Program::Resolve(bool wait)
+	{
+		if (linking.program == 0) return;
+
+		// the completion of a parallel link can be polled, otherwise reading the status waits for it
+		if (!wait && Renderer::HasParallelShaderCompile())
+		{
+			GLint complete = GL_FALSE;
+			glGetProgramiv(linking.program, GL_COMPLETION_STATUS_KHR, &complete);
+			if (complete == GL_FALSE) return;
+		}
+
+		link_t link = std::move(linking);
+		linking = link_t{};
+
+		if (!CheckLinkStatus(link.program))
+		{
+			for (auto& shader : link.shaders)
+			{
+				shader->CheckCompileStatus();
+			}
+			glDeleteProgram(link.program);
+			return;
+		}
+
+		if (!link.binaryName.empty()) WriteBinary(link.binaryName, link.key, link.program);
+
+		// swap the program object, handles resolved against the previous program stay valid
+		if (program != 0) Renderer::state.DeleteProgram(program);
+		program = link.program;
+		shaders = std::move(link.shaders);
+		bool first = !linked;
+		linked = true;
+
+		ReflectUniforms();
+		RestoreUniforms();
+
+		if (first)
+		{
+			// names requested before the first link that are not active uniforms
+			for (auto& uniform : uniforms)
+			{
+				if (uniform.type == 0) SDL_Log("Could not find uniform: %s", uniform.name.c_str());
+			}
+#ifdef _DEBUG
+			DisplayInfo();
+#endif
+		}
+	}
+
+	uint64_t Program::GetBinaryKey(const std::vector<std::shared_ptr<Shader>>& shaders)
+	{
+		uint64_t key = hash_bytes(&BinaryVersion, sizeof(BinaryVersion));
+		for (auto& shader : shaders)
+		{
+			uint64_t hash = shader->GetHash();
+			key = hash_bytes(&hash, sizeof(hash), key);
+		}
+
+		// a binary is only valid for the driver that created it
+		for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+		{
+			const char* string = reinterpret_cast<const char*>(glGetString(name));
+			if (string) key = hash_bytes(string, std::strlen(string), key);
+		}
+
+		return key;
+	}
+
+	GLuint Program::ReadBinary(const std::string& filename, uint64_t key)
+	{
+		// a loose file read directly, not through the file system
+		if (filename.empty()) return 0;
+		std::ifstream stream(filename, std::ios::binary);
+		if (!stream.is_open()) return 0;
+
+		binary_header_t header;
+		if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) return 0;
+		if (header.magic != BinaryMagic || header.version != BinaryVersion || header.key != key) return 0;
+
+		std::vector<char> binary(header.size);
+		if (!stream.read(binary.data(), binary.size())) return 0;
+
+		GLuint built = glCreateProgram();
+		glProgramBinary(built, header.format, binary.data(), (GLsizei)header.size);
+
+		// a driver can still reject a binary with a matching key, the program is then linked from source
+		GLint status;
+		glGetProgramiv(built, GL_LINK_STATUS, &status);
+		if (status == GL_FALSE)
+		{
+			glDeleteProgram(built);
+			return 0;
+		}
+
+		return built;
+	}
+
+	void Program::WriteBinary(const std::string& filename, uint64_t key, GLuint program)
+	{
+		if (filename.empty()) return;
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+
+		std::vector<uint8_t> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, &length, &format, binary.data());
+
+		binary_header_t header{};
+		header.magic = BinaryMagic;
+		header.version = BinaryVersion;
+		header.format = format;
+		header.size = (uint32_t)length;
+		header.key = key;
+
+		std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			SDL_Log("Could not write program binary (%s).", filename.c_str());
+			return;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(binary.data()), length);
+	}
+
+	bool Program::CheckLinkStatus(GLuint program)
+	{
 		GLint status;
 		glGetProgramiv(program, GL_LINK_STATUS, &status);
 		if (status == GL_FALSE)
@@ -83,101 +352,207 @@ namespace nc
 				SDL_Log("Program Info: %s", infoLog.c_str());
 			}
 
-			glDeleteProgram(program);
-			program = 0;
+			return false;
 		}
-		else
+
+		return true;
+	}
+
+	void Program::Use()
+	{
+		// the first use waits for the link, a relinked program is swapped in once it completes
+		Resolve(!linked);
+		Renderer::state.UseProgram(program);
+	}
+
+	GLint Program::GetUniformHandle(const std::string& name)
+	{
+		auto iter = handles.find(name);
+		if (iter != handles.end()) return iter->second;
+
+		// before the first link completes the name is reserved, it is matched when the uniforms are reflected
+		if (!linked && linking.program != 0)
 		{
-			linked = true;
-			DisplayInfo();
+			GLint handle = (GLint)uniforms.size();
+			uniform_t uniform;
+			uniform.name = name;
+			uniforms.push_back(uniform);
+			handles[name] = handle;
+
+			return handle;
 		}
+
+		// remember names that are not active so the error is only logged once
+		SDL_Log("Could not find uniform: %s", name.c_str());
+		handles[name] = -1;
+
+		return -1;
 	}
 
-	void Program::Use()
+	void Program::SetUniform(GLint handle, float x, float y, float z)
 	{
-		glUseProgram(program);
+		SetUniform(handle, glm::vec3{ x, y, z });
 	}
 
-	void Program::SetUniform(const std::string& name, float x, float y, float z)
+	void Program::SetUniform(GLint handle, const glm::vec2& v2)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform3f(uniform, x, y, z);
+		if (!Shadow(handle, &v2, sizeof(v2))) return;
+		glProgramUniform2f(program, uniforms[handle].location, v2[0], v2[1]);
 	}
 
-	void Program::SetUniform(const std::string& name, const glm::vec2& v2)
+	void Program::SetUniform(GLint handle, const glm::vec3& v3)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform2f(uniform, v2[0], v2[1]);
+		if (!Shadow(handle, &v3, sizeof(v3))) return;
+		glProgramUniform3f(program, uniforms[handle].location, v3[0], v3[1], v3[2]);
 	}
 
-	void Program::SetUniform(const std::string& name, const glm::vec3& v3)
+	void Program::SetUniform(GLint handle, const glm::vec4& v4)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform3f(uniform, v3[0], v3[1], v3[2]);
+		if (!Shadow(handle, &v4, sizeof(v4))) return;
+		glProgramUniform4f(program, uniforms[handle].location, v4[0], v4[1], v4[2], v4[3]);
 	}
 
-	void Program::SetUniform(const std::string& name, const glm::vec4& v4)
+	void Program::SetUniform(GLint handle, const glm::mat4& mx4)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform4f(uniform, v4[0], v4[1], v4[2], v4[3]);
+		if (!Shadow(handle, &mx4, sizeof(mx4))) return;
+		glProgramUniformMatrix4fv(program, uniforms[handle].location, 1, GL_FALSE, glm::value_ptr(mx4));
 	}
 
-	void Program::SetUniform(const std::string& name, const glm::mat4& mx4)
+	void Program::SetUniform(GLint handle, const glm::mat3& mx3)
 	{
-		GLint uniform = GetUniform(name);
-		glUniformMatrix4fv(uniform, 1, GL_FALSE, glm::value_ptr(mx4));
+		if (!Shadow(handle, &mx3, sizeof(mx3))) return;
+		glProgramUniformMatrix3fv(program, uniforms[handle].location, 1, GL_FALSE, glm::value_ptr(mx3));
 	}
 
-	void Program::SetUniform(const std::string& name, const glm::mat3& mx3)
+	void Program::SetUniform(GLint handle, float value)
 	{
-		GLint uniform = GetUniform(name);
-		glUniformMatrix3fv(uniform, 1, GL_FALSE, glm::value_ptr(mx3));
+		if (!Shadow(handle, &value, sizeof(value))) return;
+		glProgramUniform1f(program, uniforms[handle].location, value);
 	}
 
-	void Program::SetUniform(const std::string& name, float value)
+	void Program::SetUniform(GLint handle, int value)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform1f(uniform, value);
+		if (!Shadow(handle, &value, sizeof(value))) return;
+		glProgramUniform1i(program, uniforms[handle].location, value);
 	}
 
-	void Program::SetUniform(const std::string& name, int value)
+	void Program::SetUniform(GLint handle, bool value)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform1i(uniform, value);
+		SetUniform(handle, (int)value);
 	}
 
-	void Program::SetUniform(const std::string& name, bool value)
+	void Program::SetUniform(GLint handle, GLuint value)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform1i(uniform, value);
+		if (!Shadow(handle, &value, sizeof(value))) return;
+		glProgramUniform1ui(program, uniforms[handle].location, value);
 	}
 
-	void Program::SetUniform(const std::string& name, GLuint value)
+	bool Program::Shadow(GLint handle, const void* data, size_t size)
 	{
-		GLint uniform = GetUniform(name);
-		glUniform1ui(uniform, value);
+		Resolve(!linked);
+		if (!linked || handle < 0 || handle >= (GLint)uniforms.size()) return false;
+
+		// skip the upload if the value has not changed since the last upload
+		uniform_t& uniform = uniforms[handle];
+		if (uniform.set && std::memcmp(uniform.value, data, size) == 0) return false;
+
+		std::memcpy(uniform.value, data, size);
+		uniform.set = true;
+
+		return true;
 	}
 
-	GLint Program::GetUniform(const std::string& name)
+	void Program::ReflectUniforms()
 	{
-		// find uniform in map
-		auto uniform = uniforms.find(name);
-		if (uniform == uniforms.end())
+		// a relinked program keeps the handles of the uniforms it had, uniforms it lost become inactive (location -1)
+		for (auto& uniform : uniforms)
 		{
-			// add uniform to map
-			GLint uniform = glGetUniformLocation(program, name.c_str());
-			if (uniform != -1)
+			uniform.location = -1;
+		}
+
+		GLint count = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+
+		GLint maxLength = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		std::vector<GLchar> name(maxLength + 1);
+
+		for (GLint i = 0; i < count; i++)
+		{
+			uniform_t uniform;
+
+			GLsizei length = 0;
+			glGetActiveUniform(program, (GLuint)i, (GLsizei)name.size(), &length, &uniform.size, &uniform.type, name.data());
+			uniform.name.assign(name.data(), length);
+			uniform.location = glGetUniformLocation(program, uniform.name.c_str());
+
+			// uniforms inside blocks have no location, they are set through the uniform buffer
+			if (uniform.location == -1) continue;
+
+			// arrays are reported as name[0], the plain name is allowed as well
+			size_t bracket = uniform.name.find("[0]");
+			std::string plainName = (bracket != std::string::npos) ? uniform.name.substr(0, bracket) : std::string{};
+
+			GLint handle = -1;
+			auto iter = handles.find(uniform.name);
+			if ((iter == handles.end() || iter->second == -1) && !plainName.empty()) iter = handles.find(plainName);
+			if (iter != handles.end() && iter->second != -1)
 			{
-				uniforms[name] = uniform;
+				handle = iter->second;
+				uniform_t& previous = uniforms[handle];
+				// the shadowed value is kept for the restore unless the type changed
+				previous.set = previous.set && previous.type == uniform.type;
+				previous.location = uniform.location;
+				previous.type = uniform.type;
+				previous.size = uniform.size;
 			}
 			else
 			{
-				SDL_Log("Could not find uniform: %s", name.c_str());
-				return -1;
+				handle = (GLint)uniforms.size();
+				uniforms.push_back(uniform);
 			}
+			handles[uniform.name] = handle;
+			if (!plainName.empty()) handles[plainName] = handle;
 		}
+	}
 
-		return uniforms[name];
+	void Program::RestoreUniforms()
+	{
+		// a new program object starts with default values, upload the shadowed values again
+		for (auto& uniform : uniforms)
+		{
+			if (!uniform.set || uniform.location == -1) continue;
+
+			const float* value = uniform.value;
+			switch (uniform.type)
+			{
+			case GL_FLOAT:
+				glProgramUniform1fv(program, uniform.location, 1, value);
+				break;
+			case GL_FLOAT_VEC2:
+				glProgramUniform2fv(program, uniform.location, 1, value);
+				break;
+			case GL_FLOAT_VEC3:
+				glProgramUniform3fv(program, uniform.location, 1, value);
+				break;
+			case GL_FLOAT_VEC4:
+				glProgramUniform4fv(program, uniform.location, 1, value);
+				break;
+			case GL_FLOAT_MAT3:
+				glProgramUniformMatrix3fv(program, uniform.location, 1, GL_FALSE, value);
+				break;
+			case GL_FLOAT_MAT4:
+				glProgramUniformMatrix4fv(program, uniform.location, 1, GL_FALSE, value);
+				break;
+			case GL_UNSIGNED_INT:
+				glProgramUniform1uiv(program, uniform.location, 1, reinterpret_cast<const GLuint*>(value));
+				break;
+			default:
+				// ints, bools and samplers
+				glProgramUniform1iv(program, uniform.location, 1, reinterpret_cast<const GLint*>(value));
+				break;
+			}
+		}
 	}
 
 	void Program::DisplayInfo()
@@ -187,7 +562,7 @@ namespace nc
 		GLint size; // size of the variable
 		GLenum type; // type of the variable (float, vec3 or mat4, etc)
 
-		const GLsizei bufSize = 16; // maximum name length
+		const GLsizei bufSize = 64; // maximum name length
 		GLchar name[bufSize]; // variable name in GLSL
 		GLsizei length; // name length
 
@@ -201,14 +576,11 @@ namespace nc
 			printf("Attribute #%d Type: %u Name: %s\n", i, type, name);
 		}
 
-		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
-		printf("Active Uniforms: %d\n", count);
+		printf("Active Uniforms: %d\n", (int)uniforms.size());
 
-		for (GLint i = 0; i < count; i++)
+		for (size_t i = 0; i < uniforms.size(); i++)
 		{
-			glGetActiveUniform(program, (GLuint)i, bufSize, &length, &size, &type, name);
-
-			printf("Uniform #%d Type: %u Name: %s\n", i, type, name);
+			printf("Uniform #%d Type: %u Name: %s\n", (int)i, uniforms[i].type, uniforms[i].name.c_str());
 		}
 	}
 }
\ No newline at end of file
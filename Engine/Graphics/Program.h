@@ -9,11 +9,27 @@ namespace nc
 {
 	class Program : public Resource
 	{
+	public:
+		// uber shader features, each bit is compiled in as a define (DIFFUSE_MAP, NORMAL_MAP, INSTANCED, FOG)
+		enum eFeature : uint32_t
+		{
+			DiffuseMap = 1 << 0,
+			NormalMap = 1 << 1,
+			Instanced = 1 << 2,
+			Fog = 1 << 3
+		};
+
 	public:
 		Program();
 		~Program();
 
 		bool Load(const std::string& name, void* data) override;
+		bool CanReload() const override { return true; }
+		bool DependsOn(ResourceId id) const override;
+
+		// resource name of the variant of a program file compiled with the features, shaders/uber.shdr#5
+		static std::string GetVariantName(const std::string& name, uint32_t features);
+
 		void AddShader(const std::shared_ptr<Shader>& shader);
 
 		void Link();
@@ -22,25 +38,75 @@ namespace nc
 		GLuint GetID() { return program; }
 		bool IsLinked() { return linked; }
 
-		void SetUniform(const std::string& name, float x, float y, float z);
-		void SetUniform(const std::string& name, const glm::vec2& v2);
-		void SetUniform(const std::string& name, const glm::vec3& v3);
-		void SetUniform(const std::string& name, const glm::vec4& v4);
-		void SetUniform(const std::string& name, const glm::mat4& mx4);
-		void SetUniform(const std::string& name, const glm::mat3& mx3);
-		void SetUniform(const std::string& name, float value);
-		void SetUniform(const std::string& name, int value);
-		void SetUniform(const std::string& name, bool value);
-		void SetUniform(const std::string& name, GLuint value);
+		// resolve a uniform name to a handle once, then set it through the handle
+		GLint GetUniformHandle(const std::string& name);
+
+		void SetUniform(GLint handle, float x, float y, float z);
+		void SetUniform(GLint handle, const glm::vec2& v2);
+		void SetUniform(GLint handle, const glm::vec3& v3);
+		void SetUniform(GLint handle, const glm::vec4& v4);
+		void SetUniform(GLint handle, const glm::mat4& mx4);
+		void SetUniform(GLint handle, const glm::mat3& mx3);
+		void SetUniform(GLint handle, float value);
+		void SetUniform(GLint handle, int value);
+		void SetUniform(GLint handle, bool value);
+		void SetUniform(GLint handle, GLuint value);
+
+		void SetUniform(const std::string& name, float x, float y, float z) { SetUniform(GetUniformHandle(name), x, y, z); }
+		void SetUniform(const std::string& name, const glm::vec2& v2) { SetUniform(GetUniformHandle(name), v2); }
+		void SetUniform(const std::string& name, const glm::vec3& v3) { SetUniform(GetUniformHandle(name), v3); }
+		void SetUniform(const std::string& name, const glm::vec4& v4) { SetUniform(GetUniformHandle(name), v4); }
+		void SetUniform(const std::string& name, const glm::mat4& mx4) { SetUniform(GetUniformHandle(name), mx4); }
+		void SetUniform(const std::string& name, const glm::mat3& mx3) { SetUniform(GetUniformHandle(name), mx3); }
+		void SetUniform(const std::string& name, float value) { SetUniform(GetUniformHandle(name), value); }
+		void SetUniform(const std::string& name, int value) { SetUniform(GetUniformHandle(name), value); }
+		void SetUniform(const std::string& name, bool value) { SetUniform(GetUniformHandle(name), value); }
+		void SetUniform(const std::string& name, GLuint value) { SetUniform(GetUniformHandle(name), value); }
 
 	private:
-		GLint GetUniform(const std::string& name);
+		struct uniform_t
+		{
+			std::string name;
+			GLint location = -1;
+			GLenum type = 0;
+			GLint size = 0;
+
+			// last uploaded value, used to skip redundant uploads
+			float value[16] = {};
+			bool set = false;
+		};
+
+		// submits a new program object read from the program binary cache or linked from the shaders
+		bool Build(const std::string& filename, const std::vector<std::shared_ptr<Shader>>& shaders);
+		// reads the link status of the submitted program and swaps it in if it linked, wait is false to only poll
+		void Resolve(bool wait);
+		static uint64_t GetBinaryKey(const std::vector<std::shared_ptr<Shader>>& shaders);
+		static GLuint ReadBinary(const std::string& filename, uint64_t key);
+		static void WriteBinary(const std::string& filename, uint64_t key, GLuint program);
+		static bool CheckLinkStatus(GLuint program);
+
+		void ReflectUniforms();
+		void RestoreUniforms();
+		bool Shadow(GLint handle, const void* data, size_t size);
 		void DisplayInfo();
 
 	private:
 		GLuint program = 0;
 		std::vector<std::shared_ptr<Shader>> shaders;
-		std::map<std::string, GLuint> uniforms;
+		std::vector<ResourceId> dependencies;
+		std::vector<uniform_t> uniforms;
+		std::map<std::string, GLint> handles;
 		bool linked = false;
+
+		// program submitted for linking, it replaces the program once resolved
+		struct link_t
+		{
+			GLuint program = 0;
+			std::vector<std::shared_ptr<Shader>> shaders;
+			// set when the linked binary is written to the cache
+			std::string binaryName;
+			uint64_t key = 0;
+		};
+		link_t linking;
 	};
 }
@@ -0,0 +1,274 @@
+#include "RenderQueue.h"
+#include "Material.h"
+#include "VertexBuffer.h"
+#include "Renderer.h"
+#include "TextureStreamer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace nc
+{
+	void RenderQueue::Create()
+	{
+		cameraBuffer.Create(sizeof(frame_t), CameraBinding);
+		lightBuffer.Create(sizeof(light_t), LightBinding);
+		objectBuffer.Create(sizeof(glm::mat4), ObjectBinding);
+	}
+
+	void RenderQueue::Shutdown()
+	{
+		cameraBuffer.Destroy();
+		lightBuffer.Destroy();
+		objectBuffer.Destroy();
+
+		if (instanceBuffer) glDeleteBuffers(1, &instanceBuffer);
+		instanceBuffer = 0;
+		instanceCapacity = 0;
+	}
+
+	void RenderQueue::Begin(const frame_t& frame)
+	{
+		this->frame = frame;
+		frustum = Frustum{ frame.viewProjection };
+
+		packets.clear();
+		items.clear();
+		bounds.clear();
+	}
+
+	void RenderQueue::Submit(Material* material, VertexBuffer* vertexBuffer, const glm::mat4& model, const AABB& bounds, ePass pass, GLenum primitiveType)
+	{
+		if (material == nullptr || material->shader == nullptr || vertexBuffer == nullptr) return;
+
+		// view space depth of the object origin (camera looks down -z)
+		float depth = -(frame.view * model[3]).z;
+		// distance the texture levels are requested for
+		float distance = depth;
+
+		sort_t item;
+		item.key = MakeKey(pass, material->shader->GetID(), material->id, vertexBuffer->GetID(), depth);
+		item.index = (uint32_t)packets.size();
+		if (bounds.IsValid())
+		{
+			glm::vec3 center = bounds.Center();
+			glm::vec3 extents = bounds.Extents();
+			this->bounds.cx.push_back(center.x);
+			this->bounds.cy.push_back(center.y);
+			this->bounds.cz.push_back(center.z);
+			this->bounds.ex.push_back(extents.x);
+			this->bounds.ey.push_back(extents.y);
+			this->bounds.ez.push_back(extents.z);
+			this->bounds.items.push_back((uint32_t)items.size());
+
+			// the nearest point of the box is at most the extents away from the center
+			distance = -(frame.view * glm::vec4{ center, 1 }).z - glm::length(extents);
+		}
+
+		items.push_back(item);
+
+		packets.push_back({ material, vertexBuffer, primitiveType, model, distance });
+	}
+
+	void RenderQueue::Flush()
+	{
+		Cull();
+		if (streamer) RequestTextures();
+		Sort();
+
+		// per frame blocks are uploaded and bound once, every program reads them from the same bindings
+		cameraBuffer.SetData(frame);
+		cameraBuffer.Bind();
+		lightBuffer.SetData(light);
+		lightBuffer.Bind();
+		objectBuffer.Bind();
+
+		Program* program = nullptr;
+		Material* material = nullptr;
+		VertexBuffer* vertexBuffer = nullptr;
+
+		for (size_t i = 0; i < items.size();)
+		{
+			packet_t& packet = packets[items[i].index];
+
+			// transparent packets sort after opaque ones and are blended
+			bool transparent = ((items[i].key >> 60) == (uint64_t)ePass::Transparent);
+			Renderer::state.SetBlend(transparent);
+			if (transparent) Renderer::state.SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			// packets sharing a material and mesh are adjacent after the sort, draw them as one instanced batch
+			size_t count = 1;
+			if (packet.material->instancedShader)
+			{
+				while (i + count < items.size() && CanInstance(packet, packets[items[i + count].index])) count++;
+			}
+			bool instanced = (count > 1);
+
+			// only change state when the sorted key changes it
+			Program* shader = (instanced) ? packet.material->instancedShader.get() : packet.material->shader.get();
+			if (shader != program)
+			{
+				program = shader;
+				program->Use();
+				material = nullptr;
+			}
+
+			if (packet.material != material)
+			{
+				material = packet.material;
+				if (instanced) material->SetInstanced();
+				else material->Set();
+			}
+
+			if (packet.vertexBuffer != vertexBuffer)
+			{
+				vertexBuffer = packet.vertexBuffer;
+				vertexBuffer->Bind();
+			}
+
+			if (instanced)
+			{
+				instances.clear();
+				for (size_t j = i; j < i + count; j++)
+				{
+					instances.push_back(packets[items[j].index].model);
+				}
+				UploadInstances();
+				vertexBuffer->RenderInstanced((GLsizei)count, packet.primitiveType);
+			}
+			else
+			{
+				objectBuffer.SetData(packet.model);
+				vertexBuffer->Render(packet.primitiveType);
+			}
+
+			i += count;
+		}
+
+		packets.clear();
+		items.clear();
+		bounds.clear();
+	}
+
+	bool RenderQueue::CanInstance(const packet_t& packet, const packet_t& other)
+	{
+		return packet.material == other.material && packet.vertexBuffer == other.vertexBuffer && packet.primitiveType == other.primitiveType;
+	}
+
+	void RenderQueue::UploadInstances()
+	{
+		if (instanceBuffer == 0) glGenBuffers(1, &instanceBuffer);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+		GLsizeiptr size = (GLsizeiptr)(instances.size() * sizeof(glm::mat4));
+		// grow the buffer with some slack so it is not reallocated every frame
+		if (size > instanceCapacity) instanceCapacity = size * 2;
+
+		// orphan the previous contents so the driver does not wait on earlier draws
+		glBufferData(GL_SHADER_STORAGE_BUFFER, instanceCapacity, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, instances.data());
+
+		// instanced shaders read the model matrices from binding 0
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+	}
+
+	uint64_t RenderQueue::MakeKey(ePass pass, uint32_t program, uint32_t material, uint32_t mesh, float depth)
+	{
+		// the bit pattern of a positive float increases with its value, keep the top 24 bits
+		depth = (depth > 0) ? depth : 0;
+		uint32_t bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		uint64_t depthBits = bits >> 8;
+
+		// transparent geometry is drawn back to front
+		if (pass == ePass::Transparent) depthBits = ~depthBits & 0xffffff;
+
+		return ((uint64_t)pass & 0xf) << 60 |
+			((uint64_t)program & 0xfff) << 48 |
+			((uint64_t)material & 0xfff) << 36 |
+			((uint64_t)mesh & 0xfff) << 24 |
+			depthBits;
+	}
+
+	void RenderQueue::Cull()
+	{
+		size_t count = bounds.items.size();
+		if (count == 0) return;
+
+		bounds.visible.resize(count);
+		frustum.Cull(bounds.cx.data(), bounds.cy.data(), bounds.cz.data(), bounds.ex.data(), bounds.ey.data(), bounds.ez.data(), count, bounds.visible.data());
+
+		// flag culled items, then compact the item list
+		const uint64_t culled = ~0ull;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!bounds.visible[i]) items[bounds.items[i]].key = culled;
+		}
+		items.erase(std::remove_if(items.begin(), items.end(), [culled](const sort_t& item) { return item.key == culled; }), items.end());
+	}
+
+	void RenderQueue::RequestTextures()
+	{
+		// screen pixels covered by one world unit at a distance of one
+		float pixels = frame.projection[1][1] * viewportHeight * 0.5f;
+
+		for (auto& item : items)
+		{
+			const packet_t& packet = packets[item.index];
+			if (packet.material->textures.empty()) continue;
+
+			// one texture repeat spans 1 / density model units, scaled by the largest axis of the model matrix
+			float scale = std::max(std::max(glm::length(glm::vec3{ packet.model[0] }), glm::length(glm::vec3{ packet.model[1] })), glm::length(glm::vec3{ packet.model[2] }));
+			float distance = std::max(packet.distance, 0.01f);
+			float texcoordPixels = pixels / distance * scale / packet.vertexBuffer->GetTexcoordDensity();
+
+			for (auto& texture : packet.material->textures)
+			{
+				streamer->Request(texture, texcoordPixels);
+			}
+		}
+	}
+
+	void RenderQueue::bounds_t::clear()
+	{
+		cx.clear();
+		cy.clear();
+		cz.clear();
+		ex.clear();
+		ey.clear();
+		ez.clear();
+		items.clear();
+		visible.clear();
+	}
+
+	void RenderQueue::Sort()
+	{
+		// lsd radix sort, 8 bits per pass
+		scratch.resize(items.size());
+
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			size_t counts[256] = {};
+			for (auto& item : items)
+			{
+				counts[(item.key >> shift) & 0xff]++;
+			}
+
+			// skip the pass if every key has the same byte
+			if (counts[(items.empty() ? 0 : (items[0].key >> shift) & 0xff)] == items.size()) continue;
+
+			size_t offset = 0;
+			for (size_t& count : counts)
+			{
+				size_t n = count;
+				count = offset;
+				offset += n;
+			}
+
+			for (auto& item : items)
+			{
+				scratch[counts[(item.key >> shift) & 0xff]++] = item;
+			}
+			items.swap(scratch);
+		}
+	}
+}
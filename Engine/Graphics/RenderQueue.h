@@ -0,0 +1,126 @@
+#pragma once
+#include "Math/MathTypes.h"
+#include "Math/Frustum.h"
+#include "UniformBuffer.h"
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+namespace nc
+{
+	class Program;
+	class VertexBuffer;
+	class TextureStreamer;
+	struct Material;
+
+	class RenderQueue
+	{
+	public:
+		enum class ePass : uint8_t
+		{
+			Opaque,
+			Transparent
+		};
+
+		// uniform block bindings shared with the shaders
+		enum eBinding : GLuint
+		{
+			CameraBinding = 0,
+			LightBinding = 1,
+			ObjectBinding = 2
+		};
+
+		// camera matrices shared by every draw in a frame (std140 Camera block)
+		struct frame_t
+		{
+			glm::mat4 view{ 1 };
+			glm::mat4 projection{ 1 };
+			glm::mat4 viewProjection{ 1 };
+		};
+
+		// std140 Lights block, vec3 members are padded to 16 bytes
+		struct light_t
+		{
+			glm::vec4 position{ 0 };
+			glm::vec3 ambient{ 0 };
+			float pad0{ 0 };
+			glm::vec3 diffuse{ 0 };
+			float pad1{ 0 };
+			glm::vec3 specular{ 0 };
+			float pad2{ 0 };
+		};
+
+		struct packet_t
+		{
+			Material* material{ nullptr };
+			VertexBuffer* vertexBuffer{ nullptr };
+			GLenum primitiveType{ GL_TRIANGLES };
+			glm::mat4 model{ 1 };
+			// view distance to the nearest point of the bounds, or to the origin without bounds
+			float distance{ 0 };
+		};
+
+	public:
+		void Create();
+		void Shutdown();
+
+		void Begin(const frame_t& frame);
+		// packets with valid world bounds outside the camera frustum are culled at flush
+		void Submit(Material* material, VertexBuffer* vertexBuffer, const glm::mat4& model, const AABB& bounds = AABB{}, ePass pass = ePass::Opaque, GLenum primitiveType = GL_TRIANGLES);
+		void Flush();
+
+		void SetLight(const light_t& light) { this->light = light; }
+		// visible draws request the texture levels their screen size needs from the streamer
+		void SetStreamer(TextureStreamer* streamer) { this->streamer = streamer; }
+		void SetViewportHeight(int height) { viewportHeight = height; }
+
+		// key layout (msb to lsb): pass 4 | program 12 | material 12 | mesh 12 | depth 24
+		static uint64_t MakeKey(ePass pass, uint32_t program, uint32_t material, uint32_t mesh, float depth);
+
+	private:
+		struct sort_t
+		{
+			uint64_t key;
+			uint32_t index;
+		};
+
+		void Cull();
+		void RequestTextures();
+		void Sort();
+		bool CanInstance(const packet_t& packet, const packet_t& other);
+		void UploadInstances();
+
+	public:
+		frame_t frame;
+		light_t light;
+		Frustum frustum;
+
+	private:
+		std::vector<packet_t> packets;
+		std::vector<sort_t> items;
+		std::vector<sort_t> scratch;
+
+		// world bounds of the bounded packets as structure of arrays for the batched frustum test
+		struct bounds_t
+		{
+			std::vector<float> cx, cy, cz;
+			std::vector<float> ex, ey, ez;
+			std::vector<uint32_t> items;
+			std::vector<uint8_t> visible;
+
+			void clear();
+		} bounds;
+
+		// per instance model matrices for instanced batches
+		std::vector<glm::mat4> instances;
+		GLuint instanceBuffer{ 0 };
+		GLsizeiptr instanceCapacity{ 0 };
+
+		TextureStreamer* streamer{ nullptr };
+		int viewportHeight{ 0 };
+
+		UniformBuffer cameraBuffer;
+		UniformBuffer lightBuffer;
+		UniformBuffer objectBuffer;
+	};
+}
@@ -3,9 +3,13 @@
 #include <SDL_ttf.h> 
 #include <SDL_image.h>
 #include <iostream>
+#include <cstring>
 
 namespace nc
 {
+	StateCache Renderer::state;
+	bool Renderer::parallelShaderCompile = false;
+
 	void Renderer::Startup()
 	{
 		if (SDL_Init(SDL_INIT_VIDEO) != 0)
@@ -17,10 +21,15 @@ namespace nc
 			std::cout << "IMG_Init Error: " << IMG_GetError() << std::endl;
 		}
 		TTF_Init();
+
+		streamer.Startup();
 	}
 
 	void Renderer::Shutdown()
 	{
+		queue.Shutdown();
+		streamer.Shutdown();
+
 		SDL_GL_DeleteContext(context);
 		SDL_DestroyWindow(window);
 
@@ -31,6 +40,7 @@ namespace nc
 
 	void Renderer::Update(float dt)
 	{
+		streamer.Update();
 	}
 
 	void Renderer::Create(const std::string& name, int width, int height)
@@ -59,14 +69,55 @@ namespace nc
 			SDL_Log("Failed to create OpenGL context");
 			exit(-1);
 		}
+		LoadExtensions();
+
+		state.Invalidate();
+		state.SetDepthTest(true);
+
+		queue.Create();
+		queue.SetViewportHeight(height);
+		queue.SetStreamer(&streamer);
+	}
+
+	bool Renderer::HasExtension(const char* name)
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++)
+		{
+			const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+			if (extension && std::strcmp(extension, name) == 0) return true;
+		}
 
-		glEnable(GL_DEPTH_TEST);
+		return false;
+	}
+
+	void Renderer::LoadExtensions()
+	{
+		// the khr and arb versions of parallel shader compile share their tokens
+		using max_compiler_threads_t = void (APIENTRY*)(GLuint count);
+		max_compiler_threads_t maxShaderCompilerThreads = nullptr;
+		if (HasExtension("GL_KHR_parallel_shader_compile"))
+		{
+			maxShaderCompilerThreads = reinterpret_cast<max_compiler_threads_t>(SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR"));
+		}
+		else if (HasExtension("GL_ARB_parallel_shader_compile"))
+		{
+			maxShaderCompilerThreads = reinterpret_cast<max_compiler_threads_t>(SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB"));
+		}
+
+		// let the driver pick the number of compiler threads
+		if (maxShaderCompilerThreads) maxShaderCompilerThreads(0xffffffff);
+		parallelShaderCompile = (maxShaderCompilerThreads != nullptr);
 	}
 
 	void Renderer::BeginFrame()
 	{
 		glClearColor(0, 0, 0, 1);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		frameCounters = state.GetCounters();
+		state.ResetCounters();
 	}
 
 	void Renderer::EndFrame()
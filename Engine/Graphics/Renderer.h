@@ -1,11 +1,20 @@
 #pragma once
 #include "Framework/System.h"
 #include "Math/Transform.h"
+#include "RenderQueue.h"
+#include "StateCache.h"
+#include "TextureStreamer.h"
 
 #include <glad/glad.h>
 #include <SDL.h>
 #include <string>
 
+// GL_KHR_parallel_shader_compile, glad is generated without extensions
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 namespace nc
 {
 	class Renderer : public System
@@ -22,6 +31,21 @@ namespace nc
 		int GetWidth() { return width; }
 		int GetHeight() { return height; }
 
+		// state changes issued and skipped during the last frame
+		const StateCache::counters_t& GetFrameCounters() { return frameCounters; }
+
+		static bool HasExtension(const char* name);
+		// compiles and links run on driver threads, their completion can be polled without waiting
+		static bool HasParallelShaderCompile() { return parallelShaderCompile; }
+
+	private:
+		void LoadExtensions();
+
+	public:
+		RenderQueue queue;
+		TextureStreamer streamer;
+		static StateCache state;
+
 	private:
 		SDL_GLContext context;
 		SDL_Renderer* renderer{ nullptr };
@@ -29,6 +53,9 @@ namespace nc
 
 		int width;
 		int height;
-		
+
+		StateCache::counters_t frameCounters;
+
+		static bool parallelShaderCompile;
 	};
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Shader.h"
 #include "Core/FileSystem.h"
+#include "Core/Hash.h"
+#include <algorithm>
 
 namespace nc
 {
@@ -13,25 +15,67 @@ namespace nc
 	}
 
 	bool Shader::Load(const std::string& name, void* data)
+	{
+		return Decode(name, data) && Upload(name, data);
+	}
+
+	bool Shader::Decode(const std::string& name, void*)
 	{
 		// get shader source from file
-		std::string source;
-		bool success = ReadFileToString(name, source);
+		std::string filename = name.substr(0, name.find('#'));
+		bool success = ReadFileToString(filename, decoded);
 		if (success == false)
 		{
-			SDL_Log("Error: Failed to open file (%s).", name.c_str());
+			SDL_Log("Error: Failed to open file (%s).", filename.c_str());
 		}
 
+		return success;
+	}
+
+	bool Shader::Upload(const std::string& name, void* data)
+	{
+		this->name = name;
+		type = static_cast<GLenum>(reinterpret_cast<std::uintptr_t>(data));
+
+		source = std::move(decoded);
+		decoded.clear();
+
+		size_t separator = name.find('#');
+		if (separator != std::string::npos)
+		{
+			file = ResourceId{ name.substr(0, separator) };
+			AddDefines(name.substr(separator + 1));
+		}
+		hash = hash_bytes(source.data(), source.size());
+
+		// a reload compiles the new source the next time a program is linked from it
+		// programs still attached to the previous shader keep it until they are relinked
+		if (shader != 0) glDeleteShader(shader);
+		shader = 0;
+
+		return true;
+	}
+
+	GLuint Shader::Compile()
+	{
+		if (shader != 0) return shader;
+
 		// create shader
-		GLuint shaderType = static_cast<GLuint>(reinterpret_cast<std::uintptr_t>(data));
-		shader = glCreateShader(shaderType);
+		shader = glCreateShader(type);
 
-		// compile shader
+		// compile shader, the driver may compile on another thread until the status is read
 		const char* source_c = source.c_str();
 		glShaderSource(shader, 1, &source_c, NULL);
 		glCompileShader(shader);
 
-				// check shader compilation status
+		return shader;
+	}
+
+	bool Shader::CheckCompileStatus()
+	{
+		if (shader == 0) return false;
+
+		// check shader compilation status
 		GLint status;
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 		if (status == GL_FALSE)
@@ -44,14 +88,41 @@ namespace nc
 			{
 				std::string infoLog(length, ' ');
 				glGetShaderInfoLog(shader, length, &length, &infoLog[0]);
-				SDL_Log("Error: Failed to compile shader.");
+				SDL_Log("Error: Failed to compile shader (%s).", name.c_str());
 				SDL_Log("Shader Info: %s", infoLog.c_str());
 			}
 
-			// delete shader
-			glDeleteShader(shader);
-			shader = 0;
+			return false;
 		}
+
 		return true;
 	}
+
+	void Shader::AddDefines(const std::string& defines)
+	{
+		std::string lines;
+		size_t start = 0;
+		while (start < defines.size())
+		{
+			size_t end = defines.find(',', start);
+			if (end == std::string::npos) end = defines.size();
+			if (end > start) lines += "#define " + defines.substr(start, end - start) + "\n";
+			start = end + 1;
+		}
+
+		// the defines go after the #version line, which has to come first
+		size_t line = 0;
+		size_t version = source.find("#version");
+		size_t insert = 0;
+		if (version != std::string::npos)
+		{
+			insert = source.find('\n', version);
+			insert = (insert == std::string::npos) ? source.size() : insert + 1;
+			line = std::count(source.begin(), source.begin() + insert, '\n');
+		}
+
+		// keep the line numbers of compile errors matching the file
+		lines += "#line " + std::to_string(line + 1) + "\n";
+		source.insert(insert, lines);
+	}
 }
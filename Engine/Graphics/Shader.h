@@ -9,9 +9,43 @@ namespace nc
 	public:
 		~Shader();
 
+		// loading reads the source, the shader is compiled when a program is linked from source
+		// a name with a define list after # is a variant of the file compiled with the defines, shaders/uber.frag#NORMAL_MAP,FOG
 		bool Load(const std::string& name, void* data) override;
+		bool Decode(const std::string& name, void* data) override;
+		bool Upload(const std::string& name, void* data) override;
+
+		bool CanReload() const override { return true; }
+		// a variant reloads when its file changes
+		bool DependsOn(ResourceId id) const override { return file.IsValid() && id == file; }
+		size_t GetCpuBytes() const override { return source.capacity(); }
+
+		// submits the compile of the source on first use, the status is checked when a program fails to link
+		// programs read from the program binary cache never compile their shaders
+		GLuint Compile();
+		// waits for the compile and logs its errors
+		bool CheckCompileStatus();
+
+		const std::string& GetSource() const { return source; }
+		// hash of the source, part of the program binary cache key
+		uint64_t GetHash() const { return hash; }
 
 	public:
 		GLuint shader = 0;
+
+	private:
+		// inserts #define lines for a comma separated list
+		void AddDefines(const std::string& defines);
+
+	private:
+		std::string name;
+		std::string source;
+		GLenum type = 0;
+		uint64_t hash = 0;
+		// source file of a variant
+		ResourceId file;
+
+		// source read by decode, taken by upload
+		std::string decoded;
 	};
 }
@@ -0,0 +1,119 @@
+#include "StateCache.h"
+
+namespace nc
+{
+	void StateCache::UseProgram(GLuint program)
+	{
+		if (!Changed(this->program != program)) return;
+
+		this->program = program;
+		glUseProgram(program);
+	}
+
+	void StateCache::BindVertexArray(GLuint vao)
+	{
+		if (!Changed(this->vao != vao)) return;
+
+		this->vao = vao;
+		glBindVertexArray(vao);
+	}
+
+	void StateCache::BindTexture(GLenum unit, GLenum target, GLuint texture)
+	{
+		GLuint index = unit - GL_TEXTURE0;
+		if (index >= MaxTextureUnits)
+		{
+			// not tracked, always issue
+			counters.issued++;
+			glActiveTexture(unit);
+			glBindTexture(target, texture);
+			activeUnit = unit;
+			return;
+		}
+
+		texture_t& bound = textures[index];
+		if (!Changed(bound.target != target || bound.texture != texture)) return;
+
+		if (activeUnit != unit)
+		{
+			activeUnit = unit;
+			glActiveTexture(unit);
+		}
+
+		bound.target = target;
+		bound.texture = texture;
+		glBindTexture(target, texture);
+	}
+
+	void StateCache::SetDepthTest(bool enable)
+	{
+		if (!Changed(depthTest != (int)enable)) return;
+
+		depthTest = enable;
+		if (enable) glEnable(GL_DEPTH_TEST);
+		else glDisable(GL_DEPTH_TEST);
+	}
+
+	void StateCache::SetBlend(bool enable)
+	{
+		if (!Changed(blend != (int)enable)) return;
+
+		blend = enable;
+		if (enable) glEnable(GL_BLEND);
+		else glDisable(GL_BLEND);
+	}
+
+	void StateCache::SetBlendFunc(GLenum source, GLenum destination)
+	{
+		if (!Changed(blendSource != source || blendDestination != destination)) return;
+
+		blendSource = source;
+		blendDestination = destination;
+		glBlendFunc(source, destination);
+	}
+
+	void StateCache::DeleteProgram(GLuint program)
+	{
+		if (this->program == program) this->program = ~0u;
+		glDeleteProgram(program);
+	}
+
+	void StateCache::DeleteVertexArray(GLuint vao)
+	{
+		if (this->vao == vao) this->vao = ~0u;
+		glDeleteVertexArrays(1, &vao);
+	}
+
+	void StateCache::DeleteTexture(GLuint texture)
+	{
+		for (auto& bound : textures)
+		{
+			if (bound.texture == texture) bound = texture_t{};
+		}
+		glDeleteTextures(1, &texture);
+	}
+
+	void StateCache::Invalidate()
+	{
+		program = ~0u;
+		vao = ~0u;
+		activeUnit = 0;
+		for (auto& bound : textures)
+		{
+			bound = texture_t{};
+		}
+
+		depthTest = -1;
+		blend = -1;
+		blendSource = 0;
+		blendDestination = 0;
+	}
+
+	bool StateCache::Changed(bool changed)
+	{
+		if (changed) counters.issued++;
+		else counters.skipped++;
+
+		return changed;
+	}
+}
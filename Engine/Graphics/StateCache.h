@@ -0,0 +1,62 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+
+namespace nc
+{
+	// shadows the bound GL state and filters out calls that would not change it
+	class StateCache
+	{
+	public:
+		struct counters_t
+		{
+			uint32_t issued = 0;
+			uint32_t skipped = 0;
+		};
+
+	public:
+		void UseProgram(GLuint program);
+		void BindVertexArray(GLuint vao);
+		void BindTexture(GLenum unit, GLenum target, GLuint texture);
+
+		void SetDepthTest(bool enable);
+		void SetBlend(bool enable);
+		void SetBlendFunc(GLenum source, GLenum destination);
+
+		// objects must be deleted through the cache so a reused name is not mistaken for the bound one
+		void DeleteProgram(GLuint program);
+		void DeleteVertexArray(GLuint vao);
+		void DeleteTexture(GLuint texture);
+
+		// forget the shadowed state, use after GL calls made outside the cache
+		void Invalidate();
+
+		void ResetCounters() { counters = counters_t{}; }
+		const counters_t& GetCounters() const { return counters; }
+
+	private:
+		bool Changed(bool changed);
+
+	private:
+		static const int MaxTextureUnits = 32;
+
+		struct texture_t
+		{
+			GLenum target = 0;
+			GLuint texture = 0;
+		};
+
+		// ~0 marks state that is unknown and must be issued
+		GLuint program = ~0u;
+		GLuint vao = ~0u;
+		GLenum activeUnit = 0;
+		texture_t textures[MaxTextureUnits];
+
+		int depthTest = -1;
+		int blend = -1;
+		GLenum blendSource = 0;
+		GLenum blendDestination = 0;
+
+		counters_t counters;
+	};
+}
@@ -1,13 +1,72 @@
 #include "Texture.h"
+#include "Core/FileSystem.h"
+#include "Core/Utilities.h"
 #include <SDL_image.h>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
 
 namespace nc
 {
+	namespace
+	{
+		// srgb encoded 8 bit value to linear, mips of color images are averaged in linear space
+		const std::array<float, 256>& GetLinearTable()
+		{
+			static const std::array<float, 256> table = []()
+			{
+				std::array<float, 256> table;
+				for (size_t i = 0; i < table.size(); i++)
+				{
+					float v = i / 255.0f;
+					table[i] = (v <= 0.04045f) ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+				}
+				return table;
+			}();
+			return table;
+		}
+
+		bool IsBakedCurrent(const std::string& filename, const std::string& baked)
+		{
+			if (!FileExists(baked)) return false;
+
+			// a baked file without its image (packed) is used, one older than its image is not
+			std::error_code error;
+			auto sourceTime = std::filesystem::last_write_time(filename, error);
+			if (error) return true;
+			auto bakedTime = std::filesystem::last_write_time(baked, error);
+			return error || bakedTime >= sourceTime;
+		}
+
+		int GetLevelSize(int size, GLsizei level)
+		{
+			return std::max(size >> level, 1);
+		}
+
+		uint8_t LinearToSrgb(float v)
+		{
+			v = std::min(std::max(v, 0.0f), 1.0f);
+			float s = (v <= 0.0031308f) ? v * 12.92f : 1.055f * std::pow(v, 1 / 2.4f) - 0.055f;
+			return (uint8_t)(s * 255 + 0.5f);
+		}
+	}
+
+	void Texture::decoded_t::Clear()
+	{
+		if (surface) SDL_FreeSurface(surface);
+		surface = nullptr;
+		mips.clear();
+		mips.shrink_to_fit();
+		compressed.Close();
+		image = dds::image_t{};
+	}
+
 	Texture::~Texture()
 	{
-		glDeleteTextures(1, &texture);
+		Renderer::state.DeleteTexture(texture);
 	}
 
 	bool Texture::Load(const std::string& name, void* data)
@@ -16,34 +75,323 @@ namespace nc
 		return CreateTexture(name, GL_TEXTURE_2D, unit);
 	}
 
+	bool Texture::Decode(const std::string& name, void* data)
+	{
+		// a reload decodes while the texture is bound, the unit and target do not change
+		if (!IsReady())
+		{
+			this->name = name;
+			target = GL_TEXTURE_2D;
+			SetUnit(static_cast<GLuint>(reinterpret_cast<std::uintptr_t>(data)));
+		}
+		return DecodeSurface(name);
+	}
+
+	bool Texture::Upload(const std::string&, void*)
+	{
+		return UploadSurface();
+	}
+
 	bool Texture::CreateTexture(const std::string& filename, GLenum target, GLuint unit)
 	{
+		this->name = filename;
 		this->target = target;
-		this->unit = unit;
+		SetUnit(unit);
 
-		SDL_Surface* surface = IMG_Load(filename.c_str());
+		return DecodeSurface(filename) && UploadSurface();
+	}
+
+	bool Texture::DecodeSurface(const std::string& filename)
+	{
+		decoded.Clear();
+		return DecodeLevels(filename, linear, decoded);
+	}
+
+	bool Texture::DecodeLevels(const std::string& filename, bool linear, decoded_t& decoded)
+	{
+		std::string extension = std::filesystem::path{ filename }.extension().string();
+		if (istring_compare(extension, ".dds")) return DecodeCompressed(filename, decoded);
+		if (IsBakedCurrent(filename, filename + ".dds") && DecodeCompressed(filename + ".dds", decoded)) return true;
+
+		File file;
+		if (!ReadFile(filename, file))
+		{
+			SDL_Log("Failed to read image: %s", filename.c_str());
+			return false;
+		}
+		SDL_Surface* surface = IMG_Load_RW(SDL_RWFromConstMem(file.GetData(), (int)file.GetSize()), 1);
 
 		if (surface == nullptr)
 		{
 			SDL_Log("Failed to create surface: %s", SDL_GetError());
 			return false;
 		}
+
+		// uploads expect tightly ordered rgb or rgba bytes (bmp decodes as bgr, some images are paletted)
+		bool alpha = SDL_ISPIXELFORMAT_ALPHA(surface->format->format) || surface->format->Amask != 0;
+		Uint32 format = (alpha) ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24;
+		if (surface->format->format != format)
+		{
+			SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+			SDL_FreeSurface(surface);
+			surface = converted;
+			if (surface == nullptr)
+			{
+				SDL_Log("Failed to convert surface: %s", SDL_GetError());
+				return false;
+			}
+		}
 		FlipSurface(surface);
+		decoded.surface = surface;
+
+		decoded.mips.clear();
+		if (mipmaps == eMipmaps::GammaCorrect) GenerateMips(static_cast<const uint8_t*>(surface->pixels), surface->w, surface->h, surface->pitch, surface->format->BytesPerPixel, linear, decoded.mips);
+
+		return true;
+	}
+
+	bool Texture::DecodeCompressed(const std::string& filename, decoded_t& decoded)
+	{
+		// the levels are uploaded straight from the file, no decode
+		if (!ReadFile(filename, decoded.compressed) || !dds::Read(decoded.compressed.GetData(), decoded.compressed.GetSize(), decoded.image))
+		{
+			SDL_Log("Failed to read compressed image: %s", filename.c_str());
+			decoded.compressed.Close();
+			decoded.image = dds::image_t{};
+			return false;
+		}
+
+		return true;
+	}
+
+	void Texture::GenerateMips(const uint8_t* pixels, int width, int height, int pitch, int channels, bool linear, std::vector<std::vector<uint8_t>>& mips)
+	{
+		const std::array<float, 256>& toLinear = GetLinearTable();
+		// alpha is coverage, it is averaged without gamma
+		int colorChannels = (linear) ? 0 : std::min(channels, 3);
+
+		mips.clear();
+		const uint8_t* source = pixels;
+
+		while (width > 1 || height > 1)
+		{
+			int mipWidth = std::max(width / 2, 1);
+			int mipHeight = std::max(height / 2, 1);
+			std::vector<uint8_t> mip((size_t)mipWidth * mipHeight * channels);
+
+			// 2x2 box filter, the last row or column of an odd size is dropped
+			for (int y = 0; y < mipHeight; y++)
+			{
+				const uint8_t* row0 = source + std::min(y * 2, height - 1) * pitch;
+				const uint8_t* row1 = source + std::min(y * 2 + 1, height - 1) * pitch;
+				uint8_t* destination = mip.data() + (size_t)y * mipWidth * channels;
+
+				for (int x = 0; x < mipWidth; x++)
+				{
+					int x0 = std::min(x * 2, width - 1) * channels;
+					int x1 = std::min(x * 2 + 1, width - 1) * channels;
+					for (int c = 0; c < channels; c++)
+					{
+						uint8_t a = row0[x0 + c];
+						uint8_t b = row0[x1 + c];
+						uint8_t d = row1[x0 + c];
+						uint8_t e = row1[x1 + c];
+
+						if (c < colorChannels) destination[c] = LinearToSrgb((toLinear[a] + toLinear[b] + toLinear[d] + toLinear[e]) * 0.25f);
+						else destination[c] = (uint8_t)((a + b + d + e + 2) / 4);
+					}
+					destination += channels;
+				}
+			}
+
+			// the moved level keeps its buffer, the next level reads from it
+			mips.push_back(std::move(mip));
+			source = mips.back().data();
+			pitch = mipWidth * channels;
+			width = mipWidth;
+			height = mipHeight;
+		}
+	}
+
+	void Texture::SetUnit(GLuint data)
+	{
+		unit = data & ~Linear;
+		linear = (data & Linear) != 0;
+	}
+
+	float Texture::GetMaxAnisotropy()
+	{
+		static const float maxAnisotropy = []()
+		{
+			GLfloat level = 1;
+			if (Renderer::HasExtension("GL_EXT_texture_filter_anisotropic") || Renderer::HasExtension("GL_ARB_texture_filter_anisotropic"))
+			{
+				glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &level);
+			}
+			return level;
+		}();
+		return maxAnisotropy;
+	}
+
+	bool Texture::UploadSurface()
+	{
+		if (decoded.IsEmpty()) return false;
+
+		if (decoded.image.format != 0)
+		{
+			const dds::image_t& image = decoded.image;
+			width = image.width;
+			height = image.height;
+			internalFormat = image.format;
+			compressed = true;
+			levelCount = (GLsizei)image.levels.size();
+			decodedLevels = levelCount;
+		}
+		else
+		{
+			width = decoded.surface->w;
+			height = decoded.surface->h;
+			internalFormat = (decoded.surface->format->BytesPerPixel == 4) ? GL_RGBA8 : GL_RGB8;
+			compressed = false;
+			levelCount = 1;
+			if (mipmaps != eMipmaps::None)
+			{
+				for (int size = std::max(width, height); size > 1; size /= 2) levelCount++;
+			}
+			decodedLevels = 1 + (GLsizei)decoded.mips.size();
+		}
+
+		// two channel normal maps have no blue, they only work where the shaders rebuild z from rg
+		if (internalFormat == GL_COMPRESSED_RG_RGTC2 && !linear) SDL_Log("Two channel (bc5) texture used as a color texture: %s", name.c_str());
+
+		// a reload starts again from the streaming level, the resident levels belong to the previous image
+		generation++;
+		bool result = Store(GetStreamLevel(), &decoded, false);
+		decoded.Clear();
+
+		return result;
+	}
+
+	GLsizei Texture::GetStreamLevel() const
+	{
+		// levels generated by the driver only exist below a full size level 0
+		if (streamingSize <= 0 || decodedLevels < levelCount) return 0;
+
+		GLsizei level = 0;
+		while (level + 1 < levelCount && std::max(GetLevelSize(width, level), GetLevelSize(height, level)) > streamingSize) level++;
+
+		return level;
+	}
+
+	size_t Texture::GetLevelBytes(GLsizei first) const
+	{
+		size_t bytes = 0;
+		for (GLsizei level = first; level < levelCount; level++)
+		{
+			int w = GetLevelSize(width, level);
+			int h = GetLevelSize(height, level);
+			bytes += (compressed) ? dds::GetLevelSize(internalFormat, w, h) : (size_t)w * h * ((internalFormat == GL_RGBA8) ? 4 : 3);
+		}
+
+		return bytes;
+	}
+
+	bool Texture::Stream(GLsizei first, const decoded_t* decoded)
+	{
+		if (texture == 0 || first < 0 || first >= levelCount) return false;
+		if (first == baseLevel) return true;
+
+		if (first < baseLevel)
+		{
+			// the new levels must come from the image the texture holds, a reload can replace it while the levels decode
+			if (decoded == nullptr || decodedLevels < levelCount) return false;
+
+			bool matches = false;
+			if (decoded->image.format != 0)
+			{
+				const dds::image_t& image = decoded->image;
+				matches = compressed && image.format == internalFormat && image.width == width && image.height == height && (GLsizei)image.levels.size() >= levelCount;
+			}
+			else if (decoded->surface != nullptr)
+			{
+				const SDL_Surface* surface = decoded->surface;
+				GLenum format = (surface->format->BytesPerPixel == 4) ? GL_RGBA8 : GL_RGB8;
+				matches = !compressed && format == internalFormat && surface->w == width && surface->h == height && (GLsizei)decoded->mips.size() + 1 >= levelCount;
+			}
+			if (!matches) return false;
+		}
+
+		return Store(first, decoded, true);
+	}
+
+	bool Texture::Store(GLsizei first, const decoded_t* decoded, bool copyResident)
+	{
+		GLuint previous = texture;
+		bool copy = copyResident && previous != 0;
 
 		glGenTextures(1, &texture);
-		glBindTexture(target, texture);
+		Renderer::state.BindTexture(unit, target, texture);
+
+		// immutable storage for the levels from first down, level first is level 0 of the storage
+		glTexStorage2D(target, levelCount - first, internalFormat, GetLevelSize(width, first), GetLevelSize(height, first));
+
+		GLenum format = (internalFormat == GL_RGBA8) ? GL_RGBA : GL_RGB;
+		for (GLsizei level = first; level < levelCount; level++)
+		{
+			int w = GetLevelSize(width, level);
+			int h = GetLevelSize(height, level);
+
+			if (copy && level >= baseLevel)
+			{
+				// resident levels are copied on the gpu, only the missing ones are uploaded
+				glCopyImageSubData(previous, target, level - baseLevel, 0, 0, 0, texture, target, level - first, 0, 0, 0, w, h, 1);
+			}
+			else if (decoded == nullptr)
+			{
+				continue;
+			}
+			else if (compressed)
+			{
+				const dds::level_t& data = decoded->image.levels[level];
+				glCompressedTexSubImage2D(target, level - first, 0, 0, w, h, internalFormat, (GLsizei)data.size, data.data);
+			}
+			else if (level == 0)
+			{
+				// surface rows are padded to 4 bytes
+				glTexSubImage2D(target, 0, 0, 0, w, h, format, GL_UNSIGNED_BYTE, decoded->surface->pixels);
+			}
+			else if ((size_t)level <= decoded->mips.size())
+			{
+				// the cpu mips are tightly packed
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glTexSubImage2D(target, level - first, 0, 0, w, h, format, GL_UNSIGNED_BYTE, decoded->mips[level - 1].data());
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			}
+		}
+
+		if (decoded && decodedLevels < levelCount) glGenerateMipmap(target);
 
-		GLenum format = (surface->format->BytesPerPixel == 4) ? GL_RGBA : GL_RGB;
-		glTexImage2D(target, 0, format, surface->w, surface->h, 0, format, GL_UNSIGNED_BYTE, surface->pixels);
+		SetParameters(levelCount - first);
 
-		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// a reload or a streamed texture releases the previous storage
+		if (previous != 0) Renderer::state.DeleteTexture(previous);
+		baseLevel = first;
+		gpuBytes = GetLevelBytes(first);
+
+		return true;
+	}
+
+	void Texture::SetParameters(GLsizei levels)
+	{
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, (levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		//glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP);
 		//glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP);
 		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-		return true;
+		float level = std::min(anisotropy, GetMaxAnisotropy());
+		if (level > 1) glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, level);
 	}
 
 	void Texture::FlipSurface(SDL_Surface* surface)
@@ -51,7 +399,6 @@ namespace nc
 		SDL_LockSurface(surface);
 
 		int pitch = surface->pitch; // row size
-		uint8_t* temp = new uint8_t[pitch]; // intermediate buffer
 		uint8_t* pixels = (uint8_t*)surface->pixels;
 
 		for (int i = 0; i < surface->h / 2; ++i) {
@@ -59,14 +406,10 @@ namespace nc
 			uint8_t* row1 = pixels + i * pitch;
 			uint8_t* row2 = pixels + (surface->h - i - 1) * pitch;
 
-			// swap rows
-			memcpy(temp, row1, pitch);
-			memcpy(row1, row2, pitch);
-			memcpy(row2, temp, pitch);
+			// swap rows in place
+			std::swap_ranges(row1, row1 + pitch, row2);
 		}
 
-		delete[] temp;
-
 		SDL_UnlockSurface(surface);
 	}
 }
\ No newline at end of file
@@ -2,24 +2,131 @@
 #include "Renderer.h"
 #include "Resource/Resource.h"
 #include "Math/MathTypes.h"
+#include "Core/FileSystem.h"
+#include "Dds.h"
 #include <SDL.h>
+#include <vector>
+
+// GL_EXT_texture_filter_anisotropic, glad is generated without extensions
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
 
 namespace nc
 {
 	class Texture : public Resource
 	{
+	public:
+		// load data is the texture unit, or'ed with Linear for images that are not colors (normal maps)
+		static const GLuint Linear = 1u << 31;
+
+		enum class eMipmaps
+		{
+			None,
+			// glGenerateMipmap on the render thread
+			Hardware,
+			// gamma correct box filter on the decoding thread, linear images are filtered without gamma
+			GammaCorrect
+		};
+
+		// image levels decoded off the render thread, waiting for upload
+		struct decoded_t
+		{
+			decoded_t() {}
+			decoded_t(const decoded_t&) = delete;
+			decoded_t& operator = (const decoded_t&) = delete;
+			~decoded_t() { Clear(); }
+
+			void Clear();
+			bool IsEmpty() const { return surface == nullptr && image.format == 0; }
+
+			// decoded image and the levels below it when mips are built on the cpu
+			SDL_Surface* surface{ nullptr };
+			std::vector<std::vector<uint8_t>> mips;
+			// block compressed levels read in place from the file
+			File compressed;
+			dds::image_t image;
+		};
+
 	public:
 		~Texture();
 		bool Load(const std::string& name, void* null) override;
+		bool Decode(const std::string& name, void* data) override;
+		bool Upload(const std::string& name, void* data) override;
 		
-		void Bind() { glActiveTexture(unit); glBindTexture(target, texture); }
+		size_t GetGpuBytes() const override { return gpuBytes; }
+		bool CanReload() const override { return true; }
+
+		void Bind() { Renderer::state.BindTexture(unit, target, texture); }
 		bool CreateTexture(const std::string& filename, GLenum target = GL_TEXTURE_2D, GLuint unit = GL_TEXTURE0);
 
+		// streaming, level 0 is the full size image
+		// textures load the levels up to the streaming size, the texture streamer uploads and drops the levels above them
+		const std::string& GetName() const { return name; }
+		bool IsLinear() const { return linear; }
+		int GetWidth() const { return width; }
+		int GetHeight() const { return height; }
+		GLsizei GetLevelCount() const { return levelCount; }
+		GLsizei GetBaseLevel() const { return baseLevel; }
+		// changes every time a new image is uploaded (load and reload), levels decoded for another generation are stale
+		uint32_t GetGeneration() const { return generation; }
+		// the level the texture loads with, levels above it are streamed
+		GLsizei GetStreamLevel() const;
+		// gpu bytes of the levels from first down
+		size_t GetLevelBytes(GLsizei first) const;
+		// decode every level of an image on any thread, for Stream
+		static bool DecodeLevels(const std::string& filename, bool linear, decoded_t& decoded);
+		// make the levels from first down resident, the resident levels are copied on the gpu, missing ones come from decoded
+		bool Stream(GLsizei first, const decoded_t* decoded = nullptr);
+
 		static void FlipSurface(SDL_Surface* surface);
+		// levels below an 8 bit image down to 1x1, see eMipmaps::GammaCorrect
+		static void GenerateMips(const uint8_t* pixels, int width, int height, int pitch, int channels, bool linear, std::vector<std::vector<uint8_t>>& mips);
+
+		// apply to textures created afterwards, the anisotropy is clamped to what the driver supports (1 disables it)
+		static void SetMipmaps(eMipmaps mode) { mipmaps = mode; }
+		static void SetAnisotropy(float level) { anisotropy = level; }
+		// largest level size textures load with, 0 loads every level
+		static void SetStreamingSize(int size) { streamingSize = size; }
+
+	protected:
+		// image decode, safe off the render thread
+		// a baked <filename>.dds that is not older than the image is read instead of the image
+		bool DecodeSurface(const std::string& filename);
+		static bool DecodeCompressed(const std::string& filename, decoded_t& decoded);
+		bool UploadSurface();
+		// creates the storage for the levels from first down and fills it
+		// resident levels are copied from the previous storage when copyResident is set, the others are uploaded from decoded
+		bool Store(GLsizei first, const decoded_t* decoded, bool copyResident);
+		void SetParameters(GLsizei levels);
+		void SetUnit(GLuint data);
+
+		static float GetMaxAnisotropy();
 
 	protected:
+		decoded_t decoded;
+
+		std::string name;
 		GLenum target{ GL_TEXTURE_2D };
 		GLuint unit{ GL_TEXTURE0 };
+		bool linear{ false };
 		GLuint texture{ 0 };
+		size_t gpuBytes{ 0 };
+
+		// full size and format of the image, the storage holds the levels from baseLevel down
+		int width{ 0 };
+		int height{ 0 };
+		GLenum internalFormat{ 0 };
+		bool compressed{ false };
+		GLsizei levelCount{ 0 };
+		GLsizei baseLevel{ 0 };
+		// levels of the decoded image, the others are generated by the driver (eMipmaps::Hardware) and cannot be streamed
+		GLsizei decodedLevels{ 0 };
+		uint32_t generation{ 0 };
+
+		static inline eMipmaps mipmaps{ eMipmaps::GammaCorrect };
+		static inline float anisotropy{ 8.0f };
+		static inline int streamingSize{ 64 };
 	};
-}
\ No newline at end of file
+}
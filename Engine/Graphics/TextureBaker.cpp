@@ -0,0 +1,354 @@
+#include "TextureBaker.h"
+#include "Texture.h"
+#include "Dds.h"
+#include "Core/FileSystem.h"
+#include "Core/Utilities.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+#include <cstring>
+
+namespace nc
+{
+	namespace
+	{
+		uint16_t To565(const int* color)
+		{
+			int r = (color[0] * 31 + 127) / 255;
+			int g = (color[1] * 63 + 127) / 255;
+			int b = (color[2] * 31 + 127) / 255;
+			return (uint16_t)((r << 11) | (g << 5) | b);
+		}
+
+		void From565(uint16_t value, int* color)
+		{
+			// replicate the high bits into the low bits, as the hardware expands them
+			int r = (value >> 11) & 31;
+			int g = (value >> 5) & 63;
+			int b = value & 31;
+			color[0] = (r << 3) | (r >> 2);
+			color[1] = (g << 2) | (g >> 4);
+			color[2] = (b << 3) | (b >> 2);
+		}
+
+		void Write16(uint8_t* data, uint16_t value)
+		{
+			data[0] = (uint8_t)(value & 0xff);
+			data[1] = (uint8_t)(value >> 8);
+		}
+
+		// bc4 block of one channel, also the alpha block of bc3
+		void EncodeChannel(const uint8_t* texels, int channel, uint8_t* block)
+		{
+			int min = 255;
+			int max = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				int value = texels[i * 4 + channel];
+				min = std::min(min, value);
+				max = std::max(max, value);
+			}
+
+			// max first selects the 8 value mode, the 6 interpolated values lie between the endpoints
+			block[0] = (uint8_t)max;
+			block[1] = (uint8_t)min;
+
+			int palette[8];
+			palette[0] = max;
+			palette[1] = min;
+			for (int i = 1; i < 7; i++)
+			{
+				palette[i + 1] = ((7 - i) * max + i * min + 3) / 7;
+			}
+
+			uint64_t indices = 0;
+			if (max != min)
+			{
+				for (int i = 0; i < 16; i++)
+				{
+					int value = texels[i * 4 + channel];
+					int best = 0;
+					int bestError = 256;
+					for (int j = 0; j < 8; j++)
+					{
+						int error = std::abs(palette[j] - value);
+						if (error < bestError)
+						{
+							best = j;
+							bestError = error;
+						}
+					}
+					indices |= (uint64_t)best << (3 * i);
+				}
+			}
+
+			for (int i = 0; i < 6; i++)
+			{
+				block[2 + i] = (uint8_t)(indices >> (8 * i));
+			}
+		}
+
+		bool HasAlpha(const uint8_t* pixels, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				if (pixels[i * 4 + 3] != 255) return true;
+			}
+			return false;
+		}
+
+		bool IsImage(const std::filesystem::path& path)
+		{
+			std::string extension = string_tolower(path.extension().string());
+			return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" || extension == ".tga";
+		}
+	}
+
+	void TextureBaker::EncodeBC1(const uint8_t* texels, uint8_t* block)
+	{
+		// principal axis of the colors by power iteration on the covariance
+		float mean[3] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++) mean[c] += texels[i * 4 + c] / 16.0f;
+		}
+
+		float covariance[6] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float r = texels[i * 4 + 0] - mean[0];
+			float g = texels[i * 4 + 1] - mean[1];
+			float b = texels[i * 4 + 2] - mean[2];
+			covariance[0] += r * r;
+			covariance[1] += r * g;
+			covariance[2] += r * b;
+			covariance[3] += g * g;
+			covariance[4] += g * b;
+			covariance[5] += b * b;
+		}
+
+		// start from the covariance column of the widest channel, a fixed start can be orthogonal to the axis
+		float axis[3] = { covariance[0], covariance[1], covariance[2] };
+		if (covariance[3] > covariance[0] && covariance[3] >= covariance[5])
+		{
+			axis[0] = covariance[1];
+			axis[1] = covariance[3];
+			axis[2] = covariance[4];
+		}
+		else if (covariance[5] > covariance[0])
+		{
+			axis[0] = covariance[2];
+			axis[1] = covariance[4];
+			axis[2] = covariance[5];
+		}
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			float length = std::max(std::max(std::abs(x), std::abs(y)), std::abs(z));
+			if (length == 0) break;
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+
+		// the texels furthest along the axis are the endpoints
+		int minTexel = 0;
+		int maxTexel = 0;
+		float minDot = 0;
+		float maxDot = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			float dot = texels[i * 4 + 0] * axis[0] + texels[i * 4 + 1] * axis[1] + texels[i * 4 + 2] * axis[2];
+			if (i == 0 || dot < minDot)
+			{
+				minDot = dot;
+				minTexel = i;
+			}
+			if (i == 0 || dot > maxDot)
+			{
+				maxDot = dot;
+				maxTexel = i;
+			}
+		}
+
+		int color0[3] = { texels[maxTexel * 4 + 0], texels[maxTexel * 4 + 1], texels[maxTexel * 4 + 2] };
+		int color1[3] = { texels[minTexel * 4 + 0], texels[minTexel * 4 + 1], texels[minTexel * 4 + 2] };
+		uint16_t endpoint0 = To565(color0);
+		uint16_t endpoint1 = To565(color1);
+
+		// endpoint0 > endpoint1 selects the four color mode
+		if (endpoint0 < endpoint1) std::swap(endpoint0, endpoint1);
+
+		Write16(block + 0, endpoint0);
+		Write16(block + 2, endpoint1);
+
+		uint32_t indices = 0;
+		if (endpoint0 != endpoint1)
+		{
+			int palette[4][3];
+			From565(endpoint0, palette[0]);
+			From565(endpoint1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0;
+				int bestError = 0;
+				for (int j = 0; j < 4; j++)
+				{
+					int error = 0;
+					for (int c = 0; c < 3; c++)
+					{
+						int d = palette[j][c] - texels[i * 4 + c];
+						error += d * d;
+					}
+					if (j == 0 || error < bestError)
+					{
+						best = j;
+						bestError = error;
+					}
+				}
+				indices |= (uint32_t)best << (2 * i);
+			}
+		}
+
+		Write16(block + 4, (uint16_t)(indices & 0xffff));
+		Write16(block + 6, (uint16_t)(indices >> 16));
+	}
+
+	void TextureBaker::EncodeBC3(const uint8_t* texels, uint8_t* block)
+	{
+		EncodeChannel(texels, 3, block);
+		EncodeBC1(texels, block + 8);
+	}
+
+	void TextureBaker::EncodeBC5(const uint8_t* texels, uint8_t* block)
+	{
+		EncodeChannel(texels, 0, block);
+		EncodeChannel(texels, 1, block + 8);
+	}
+
+	bool TextureBaker::Bake(const std::string& filename, eFormat format)
+	{
+		File file;
+		if (!ReadFile(filename, file))
+		{
+			SDL_Log("Failed to read image: %s", filename.c_str());
+			return false;
+		}
+
+		SDL_Surface* loaded = IMG_Load_RW(SDL_RWFromConstMem(file.GetData(), (int)file.GetSize()), 1);
+		if (loaded == nullptr)
+		{
+			SDL_Log("Failed to create surface: %s", SDL_GetError());
+			return false;
+		}
+
+		// rgba rows without padding, flipped as the textures are uploaded
+		SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(loaded);
+		if (surface == nullptr)
+		{
+			SDL_Log("Failed to convert surface: %s", SDL_GetError());
+			return false;
+		}
+		Texture::FlipSurface(surface);
+
+		int width = surface->w;
+		int height = surface->h;
+		std::vector<uint8_t> pixels((size_t)width * height * 4);
+		for (int y = 0; y < height; y++)
+		{
+			std::memcpy(pixels.data() + (size_t)y * width * 4, static_cast<const uint8_t*>(surface->pixels) + (size_t)y * surface->pitch, (size_t)width * 4);
+		}
+		SDL_FreeSurface(surface);
+
+		if (format == eFormat::Auto)
+		{
+			if (IsNormalMap(filename)) format = eFormat::BC5;
+			else format = (HasAlpha(pixels.data(), (size_t)width * height)) ? eFormat::BC3 : eFormat::BC1;
+		}
+
+		// normal maps are filtered without gamma
+		std::vector<std::vector<uint8_t>> images;
+		Texture::GenerateMips(pixels.data(), width, height, width * 4, 4, format == eFormat::BC5, images);
+		images.insert(images.begin(), std::move(pixels));
+
+		GLenum glFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		if (format == eFormat::BC3) glFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		if (format == eFormat::BC5) glFormat = GL_COMPRESSED_RG_RGTC2;
+		size_t blockSize = dds::GetBlockSize(glFormat);
+
+		std::vector<std::vector<uint8_t>> levels;
+		int levelWidth = width;
+		int levelHeight = height;
+		for (auto& image : images)
+		{
+			std::vector<uint8_t> level(dds::GetLevelSize(glFormat, levelWidth, levelHeight));
+			uint8_t* block = level.data();
+
+			for (int by = 0; by < levelHeight; by += 4)
+			{
+				for (int bx = 0; bx < levelWidth; bx += 4)
+				{
+					// blocks past the edge of small levels repeat the last row and column
+					uint8_t texels[16 * 4];
+					for (int y = 0; y < 4; y++)
+					{
+						for (int x = 0; x < 4; x++)
+						{
+							int sx = std::min(bx + x, levelWidth - 1);
+							int sy = std::min(by + y, levelHeight - 1);
+							std::memcpy(texels + (y * 4 + x) * 4, image.data() + ((size_t)sy * levelWidth + sx) * 4, 4);
+						}
+					}
+
+					if (format == eFormat::BC1) EncodeBC1(texels, block);
+					else if (format == eFormat::BC3) EncodeBC3(texels, block);
+					else EncodeBC5(texels, block);
+					block += blockSize;
+				}
+			}
+
+			levels.push_back(std::move(level));
+			levelWidth = std::max(levelWidth / 2, 1);
+			levelHeight = std::max(levelHeight / 2, 1);
+		}
+
+		const char* formats[] = { "auto", "bc1", "bc3", "bc5" };
+		SDL_Log("Baking %s as %s.", filename.c_str(), formats[(int)format]);
+
+		return dds::Write(filename + ".dds", glFormat, width, height, levels);
+	}
+
+	bool TextureBaker::IsNormalMap(const std::string& filename)
+	{
+		std::string stem = string_tolower(std::filesystem::path{ filename }.stem().string());
+		const std::string suffix = "_normal";
+		return stem.size() >= suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	size_t TextureBaker::BakeDirectory(const std::string& directory)
+	{
+		size_t count = 0;
+
+		std::error_code error;
+		for (auto iter = std::filesystem::recursive_directory_iterator(directory, error); !error && iter != std::filesystem::recursive_directory_iterator(); iter.increment(error))
+		{
+			std::error_code fileError;
+			if (!iter->is_regular_file(fileError) || !IsImage(iter->path())) continue;
+
+			std::string name = iter->path().lexically_relative(directory).generic_string();
+			if (Bake(name)) count++;
+		}
+
+		return count;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace nc
+{
+	// bakes images into block compressed dds files the texture loader reads instead of the image
+	// the baked files are flipped for upload and hold the full gamma correct mip chain
+	// normal maps are found by name: an image named <name>_normal.<ext> is baked as two channel bc5,
+	// it must be used where the shaders read a normal map (the second texture of a material)
+	class TextureBaker
+	{
+	public:
+		enum class eFormat
+		{
+			// bc5 for normal maps (IsNormalMap), bc3 for images with alpha, bc1 otherwise
+			Auto,
+			BC1,
+			BC3,
+			// two channel normal maps, the shader rebuilds z
+			BC5
+		};
+
+	public:
+		// writes <filename>.dds
+		static bool Bake(const std::string& filename, eFormat format = eFormat::Auto);
+		// bakes every png, jpg, bmp and tga under the directory, returns the number of baked images
+		static size_t BakeDirectory(const std::string& directory);
+		// the file name ends in _normal before the extension (bricks_normal.png)
+		static bool IsNormalMap(const std::string& filename);
+
+		// encode a 4x4 block of rgba texels (row by row) into 8 (bc1) or 16 bytes
+		static void EncodeBC1(const uint8_t* texels, uint8_t* block);
+		static void EncodeBC3(const uint8_t* texels, uint8_t* block);
+		static void EncodeBC5(const uint8_t* texels, uint8_t* block);
+	};
+}
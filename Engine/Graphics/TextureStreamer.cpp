@@ -0,0 +1,209 @@
+#include "TextureStreamer.h"
+#include "Texture.h"
+#include "Resource/ResourceSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <queue>
+
+namespace nc
+{
+	struct TextureStreamer::job_t
+	{
+		std::shared_ptr<Texture> texture;
+		GLsizei level{ 0 };
+		// generation of the texture image when the decode was queued
+		uint32_t generation{ 0 };
+		Texture::decoded_t decoded;
+		std::future<bool> done;
+	};
+
+	void TextureStreamer::Startup(size_t threads)
+	{
+		pool.Startup(threads);
+	}
+
+	void TextureStreamer::Shutdown()
+	{
+		pool.Shutdown();
+		jobs.clear();
+		streams.clear();
+		residentBytes = 0;
+	}
+
+	void TextureStreamer::Request(const std::shared_ptr<Texture>& texture, float texcoordPixels)
+	{
+		if (!texture) return;
+
+		// a new texture, or a new one at the address of a released texture
+		stream_t& stream = streams[texture.get()];
+		if (stream.texture.expired())
+		{
+			stream = stream_t{};
+			stream.texture = texture;
+		}
+
+		// the size is known once the texture is uploaded
+		if (!texture->IsReady() || texture->GetLevelCount() == 0) return;
+
+		// level L has size / 2^L texels per repeat, the coarsest level with a texel per pixel
+		int size = std::max(texture->GetWidth(), texture->GetHeight());
+		int last = texture->GetLevelCount() - 1;
+		int level = (texcoordPixels > 0) ? (int)std::floor(std::log2(size / texcoordPixels)) : last;
+		level = std::min(std::max(level, 0), last);
+
+		stream.requested = (stream.requested < 0) ? level : std::min(stream.requested, level);
+	}
+
+	void TextureStreamer::Update()
+	{
+		frame++;
+
+		// finished decodes first, they change the resident levels the budget starts from
+		size_t uploads = 0;
+		for (auto iter = jobs.begin(); iter != jobs.end() && uploads < maxUploads;)
+		{
+			if ((*iter)->done.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				iter++;
+				continue;
+			}
+
+			Finish(**iter);
+			iter = jobs.erase(iter);
+			uploads++;
+		}
+
+		// the streams only observe their textures, hold them for the rest of the update
+		std::vector<std::shared_ptr<Texture>> textures;
+		std::vector<std::pair<stream_t*, Texture*>> active;
+		for (auto iter = streams.begin(); iter != streams.end();)
+		{
+			stream_t& stream = iter->second;
+			std::shared_ptr<Texture> texture = stream.texture.lock();
+			if (!texture)
+			{
+				iter = streams.erase(iter);
+				continue;
+			}
+			iter++;
+
+			if (!texture->IsReady() || texture->GetLevelCount() == 0) continue;
+
+			// the finest level drawn recently stays resident, a coarser demand is only followed after keepFrames
+			int tail = texture->GetStreamLevel();
+			int needed = (stream.requested >= 0) ? std::min(stream.requested, tail) : tail;
+			if (stream.wanted < 0 || needed <= stream.wanted || frame - stream.lastNeeded > keepFrames)
+			{
+				if (stream.wanted < 0 || needed <= stream.wanted) stream.lastNeeded = frame;
+				stream.wanted = needed;
+			}
+			stream.wanted = std::min(stream.wanted, tail);
+			stream.requested = -1;
+
+			active.push_back({ &stream, texture.get() });
+			textures.push_back(std::move(texture));
+		}
+
+		FitBudget(active);
+
+		// drops are copies on the gpu and done at once, the largest missing levels are decoded first
+		std::vector<std::pair<stream_t*, Texture*>> missing;
+		residentBytes = 0;
+		for (auto& [stream, texture] : active)
+		{
+			GLsizei base = texture->GetBaseLevel();
+			if (stream->target > base && !stream->streaming)
+			{
+				texture->Stream(stream->target);
+				UpdateUsage(*texture);
+			}
+			else if (stream->target < base && !stream->streaming && !stream->failed)
+			{
+				missing.push_back({ stream, texture });
+			}
+			residentBytes += texture->GetGpuBytes();
+		}
+
+		std::sort(missing.begin(), missing.end(), [](const auto& a, const auto& b)
+			{
+				return a.second->GetBaseLevel() - a.first->target > b.second->GetBaseLevel() - b.first->target;
+			});
+
+		for (auto& [stream, texture] : missing)
+		{
+			if (jobs.size() >= maxJobs) break;
+
+			std::shared_ptr<job_t> job = std::make_shared<job_t>();
+			job->texture = stream->texture.lock();
+			job->level = stream->target;
+			job->generation = texture->GetGeneration();
+			job->done = pool.Enqueue([job, name = texture->GetName(), linear = texture->IsLinear()]() { return Texture::DecodeLevels(name, linear, job->decoded); });
+			jobs.push_back(std::move(job));
+
+			stream->streaming = true;
+		}
+	}
+
+	void TextureStreamer::FitBudget(std::vector<std::pair<stream_t*, Texture*>>& active)
+	{
+		size_t total = 0;
+		for (auto& [stream, texture] : active)
+		{
+			stream->target = stream->wanted;
+			total += texture->GetLevelBytes(stream->target);
+		}
+		if (total <= budget) return;
+
+		// over budget, drop the largest finest level until the rest fits, large textures lose detail first
+		using level_t = std::pair<size_t, size_t>;
+		std::priority_queue<level_t> levels;
+		auto push = [&](size_t i)
+		{
+			auto& [stream, texture] = active[i];
+			if (stream->target < texture->GetStreamLevel())
+			{
+				levels.push({ texture->GetLevelBytes(stream->target) - texture->GetLevelBytes(stream->target + 1), i });
+			}
+		};
+		for (size_t i = 0; i < active.size(); i++) push(i);
+
+		while (total > budget && !levels.empty())
+		{
+			auto [bytes, i] = levels.top();
+			levels.pop();
+
+			active[i].first->target++;
+			total -= bytes;
+			push(i);
+		}
+	}
+
+	void TextureStreamer::Finish(job_t& job)
+	{
+		bool decoded = job.done.get();
+
+		auto iter = streams.find(job.texture.get());
+		if (iter == streams.end() || iter->second.texture.lock() != job.texture) return;
+
+		stream_t& stream = iter->second;
+		stream.streaming = false;
+		if (!decoded)
+		{
+			stream.failed = true;
+			return;
+		}
+
+		// a reload replaced the image while the levels decoded, the file is decoded again for the new image
+		if (job.generation != job.texture->GetGeneration()) return;
+
+		// the demand can have fallen while the levels decoded
+		GLsizei level = std::max(job.level, (GLsizei)stream.target);
+		if (level < job.texture->GetBaseLevel() && job.texture->Stream(level, &job.decoded)) UpdateUsage(*job.texture);
+	}
+
+	void TextureStreamer::UpdateUsage(const Texture& texture)
+	{
+		if (resourceSystem) resourceSystem->UpdateUsage(ResourceId{ texture.GetName() });
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "Framework/ThreadPool.h"
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace nc
+{
+	class Texture;
+	class ResourceSystem;
+
+	// keeps the texture levels the draws need resident within a gpu memory budget
+	// the render queue requests the screen size of the textures it draws, levels finer than the demand are dropped
+	// and missing levels are decoded on a worker thread, the resident levels are copied on the gpu into the larger storage
+	class TextureStreamer
+	{
+	public:
+		TextureStreamer() {}
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer& operator = (const TextureStreamer&) = delete;
+
+		void Startup(size_t threads = 1);
+		// waits for the decodes in flight
+		void Shutdown();
+
+		// texcoordPixels is the screen size in pixels of one texture repeat (texcoord 0 to 1)
+		void Request(const std::shared_ptr<Texture>& texture, float texcoordPixels);
+		// once per frame on the render thread, fits the requested levels in the budget, drops levels and uploads finished decodes
+		void Update();
+
+		// gpu bytes of the requested textures, the levels a texture loads with are kept even over budget
+		void SetBudget(size_t bytes) { budget = bytes; }
+		// frames a level stays resident after it was last needed
+		void SetKeepFrames(uint32_t frames) { keepFrames = frames; }
+		// the resource system accounts the memory of the textures as their levels change
+		void SetResourceSystem(ResourceSystem* resourceSystem) { this->resourceSystem = resourceSystem; }
+
+		size_t GetResidentBytes() const { return residentBytes; }
+		size_t GetPendingCount() const { return jobs.size(); }
+
+	private:
+		struct stream_t
+		{
+			std::weak_ptr<Texture> texture;
+			// finest level requested this frame, -1 if the texture was not drawn
+			int requested{ -1 };
+			// finest level needed in the last keepFrames frames
+			int wanted{ -1 };
+			uint64_t lastNeeded{ 0 };
+			// wanted level after the budget
+			int target{ 0 };
+			bool streaming{ false };
+			// a failed decode is not retried
+			bool failed{ false };
+		};
+
+		// levels decoding on a worker thread
+		struct job_t;
+
+		void FitBudget(std::vector<std::pair<stream_t*, Texture*>>& active);
+		void Finish(job_t& job);
+		void UpdateUsage(const Texture& texture);
+
+	private:
+		std::unordered_map<const Texture*, stream_t> streams;
+		std::list<std::shared_ptr<job_t>> jobs;
+		ThreadPool pool;
+		ResourceSystem* resourceSystem{ nullptr };
+
+		size_t budget{ 256 * 1024 * 1024 };
+		uint32_t keepFrames{ 120 };
+		// decodes in flight, and finished decodes uploaded per frame
+		size_t maxJobs{ 4 };
+		size_t maxUploads{ 2 };
+
+		uint64_t frame{ 0 };
+		size_t residentBytes{ 0 };
+	};
+}
@@ -0,0 +1,36 @@
+#include "UniformBuffer.h"
+
+namespace nc
+{
+	UniformBuffer::~UniformBuffer()
+	{
+		Destroy();
+	}
+
+	void UniformBuffer::Create(GLsizeiptr size, GLuint binding)
+	{
+		this->size = size;
+		this->binding = binding;
+
+		glGenBuffers(1, &ubo);
+		glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	void UniformBuffer::Destroy()
+	{
+		if (ubo) glDeleteBuffers(1, &ubo);
+		ubo = 0;
+	}
+
+	void UniformBuffer::SetData(const void* data, GLsizeiptr size, GLintptr offset)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+	}
+
+	void UniformBuffer::Bind()
+	{
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
+	}
+}
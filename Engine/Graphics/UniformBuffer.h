@@ -0,0 +1,26 @@
+#pragma once
+#include <glad/glad.h>
+
+namespace nc
+{
+	// std140 uniform block storage, shared by every program that declares the block at the same binding
+	class UniformBuffer
+	{
+	public:
+		~UniformBuffer();
+
+		void Create(GLsizeiptr size, GLuint binding);
+		void Destroy();
+
+		void SetData(const void* data, GLsizeiptr size, GLintptr offset = 0);
+		template<typename T>
+		void SetData(const T& data) { SetData(&data, sizeof(T)); }
+
+		void Bind();
+
+	private:
+		GLuint ubo = 0;
+		GLuint binding = 0;
+		GLsizeiptr size = 0;
+	};
+}
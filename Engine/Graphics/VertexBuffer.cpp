@@ -5,12 +5,12 @@ namespace nc
 	VertexBuffer::VertexBuffer()
 	{
 		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
+		Bind();
 	}
 
 	VertexBuffer::~VertexBuffer()
 	{
-		if (vao) glDeleteVertexArrays(1, &vao);
+		if (vao) Renderer::state.DeleteVertexArray(vao);
 		if (vbo) glDeleteBuffers(1, &vbo);
 		if (ibo) glDeleteBuffers(1, &ibo);
 	}
@@ -24,15 +24,21 @@ namespace nc
 	{
 		this->vertexCount = vertexCount;
 
+		// the attributes set after this are recorded in the bound vertex array, a deferred upload must not write into another mesh
+		Bind();
+
+		// replacing the data must not leak the previous buffer
+		if (vbo) glDeleteBuffers(1, &vbo);
 		glGenBuffers(1, &vbo);
 		glBindBuffer(GL_ARRAY_BUFFER, vbo);
 		glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+		vertexBytes = size;
 	}
 
-	void VertexBuffer::SetAttribute(int index, GLint size, GLsizei stride, size_t offset)
+	void VertexBuffer::SetAttribute(int index, GLint size, GLsizei stride, size_t offset, GLenum type, GLboolean normalized)
 	{
 		glEnableVertexAttribArray(index);
-		glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, (void*)(offset));
+		glVertexAttribPointer(index, size, type, normalized, stride, (void*)(offset));
 	}
 
 	void VertexBuffer::CreateIndexBuffer(GLenum indexType, GLsizei indexCount, void* data)
@@ -40,16 +46,52 @@ namespace nc
 		this->indexType = indexType;
 		this->indexCount = indexCount;
 
+		// the element buffer binding is part of the vertex array state
+		Bind();
+
+		if (ibo) glDeleteBuffers(1, &ibo);
 		glGenBuffers(1, &ibo);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
 		size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, data, GL_STATIC_DRAW);
+		indexBytes = indexCount * indexSize;
+	}
+
+	void VertexBuffer::SetSubmeshes(const std::vector<submesh_t>& submeshes)
+	{
+		this->submeshes = submeshes;
+
+		counts.clear();
+		offsets.clear();
+		baseVertices.clear();
+
+		size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+		for (auto& submesh : submeshes)
+		{
+			counts.push_back(submesh.indexCount);
+			offsets.push_back((const void*)(submesh.firstIndex * indexSize));
+			baseVertices.push_back(submesh.baseVertex);
+		}
 	}
 
 	void VertexBuffer::Draw(GLenum primitiveType)
 	{
-		glBindVertexArray(vao);
-		if (ibo)
+		Bind();
+		Render(primitiveType);
+	}
+
+	void VertexBuffer::Render(GLenum primitiveType)
+	{
+		if (ibo && submeshes.size() > 1)
+		{
+			// every submesh in one call
+			glMultiDrawElementsBaseVertex(primitiveType, counts.data(), indexType, offsets.data(), (GLsizei)submeshes.size(), baseVertices.data());
+		}
+		else if (ibo && submeshes.size() == 1)
+		{
+			glDrawElementsBaseVertex(primitiveType, counts[0], indexType, offsets[0], baseVertices[0]);
+		}
+		else if (ibo)
 		{
 			glDrawElements(primitiveType, indexCount, indexType, 0);
 		}
@@ -58,4 +100,24 @@ namespace nc
 			glDrawArrays(primitiveType, 0, vertexCount);
 		}
 	}
+
+	void VertexBuffer::RenderInstanced(GLsizei instanceCount, GLenum primitiveType)
+	{
+		if (ibo && !submeshes.empty())
+		{
+			// there is no instanced multi draw without indirect buffers, draw each submesh
+			for (size_t i = 0; i < submeshes.size(); i++)
+			{
+				glDrawElementsInstancedBaseVertex(primitiveType, counts[i], indexType, offsets[i], instanceCount, baseVertices[i]);
+			}
+		}
+		else if (ibo)
+		{
+			glDrawElementsInstanced(primitiveType, indexCount, indexType, 0, instanceCount);
+		}
+		else if (vbo)
+		{
+			glDrawArraysInstanced(primitiveType, 0, vertexCount, instanceCount);
+		}
+	}
 }
@@ -7,21 +7,44 @@ namespace nc
 {
 	class VertexBuffer : public Resource
 	{
+	public:
+		// range of the index buffer drawn as one part of a mesh, indices are relative to baseVertex
+		struct submesh_t
+		{
+			GLint baseVertex{ 0 };
+			GLuint firstIndex{ 0 };
+			GLsizei indexCount{ 0 };
+			GLuint materialIndex{ 0 };
+		};
+
 	public:
 		VertexBuffer();
 		virtual ~VertexBuffer();
 
 		bool Load(const std::string& name, void* null = nullptr) override;
+		size_t GetGpuBytes() const override { return vertexBytes + indexBytes; }
 
 		// vertex buffer
 		void CreateVertexBuffer(GLsizei size, GLsizei vertexCount, void* data);
-		void SetAttribute(int index, GLint size, GLsizei stride, size_t offset);
+		// integer types with normalized set are read as [-1, 1] (signed) or [0, 1] (unsigned) floats
+		void SetAttribute(int index, GLint size, GLsizei stride, size_t offset, GLenum type = GL_FLOAT, GLboolean normalized = GL_FALSE);
 		// vertex index buffer
 		void CreateIndexBuffer(GLenum indexType, GLsizei count, void* data);
+		// draw the index buffer as separate ranges, without submeshes the whole buffer is drawn
+		void SetSubmeshes(const std::vector<submesh_t>& submeshes);
+		const std::vector<submesh_t>& GetSubmeshes() const { return submeshes; }
 
 		virtual void Draw(GLenum primitiveType = GL_TRIANGLES);
+		// draw without binding, the vertex array must already be bound
+		void Render(GLenum primitiveType = GL_TRIANGLES);
+		void RenderInstanced(GLsizei instanceCount, GLenum primitiveType = GL_TRIANGLES);
+
+		// texcoord units per model space unit, the texture streamer estimates the texture levels a draw needs from it
+		void SetTexcoordDensity(float density) { texcoordDensity = density; }
+		float GetTexcoordDensity() const { return texcoordDensity; }
 
-		void Bind() { glBindVertexArray(vao); }
+		void Bind() { Renderer::state.BindVertexArray(vao); }
+		GLuint GetID() { return vao; }
 
 	protected:
 		GLuint vao = 0; // vertex array object
@@ -32,5 +55,16 @@ namespace nc
 		GLuint ibo = 0; // index buffer object
 		GLuint indexCount = 0;  // number of indices in index buffer
 		GLenum indexType = 0;	// data type of index (GLushort or GLuint)
+
+		size_t vertexBytes = 0;
+		size_t indexBytes = 0;
+
+		std::vector<submesh_t> submeshes;
+		// submesh ranges in the layout glMultiDrawElementsBaseVertex expects
+		std::vector<GLsizei> counts;
+		std::vector<const void*> offsets;
+		std::vector<GLint> baseVertices;
+
+		float texcoordDensity = 1;
 	};
 }
\ No newline at end of file
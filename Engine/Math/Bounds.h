@@ -0,0 +1,65 @@
+#pragma once
+#include "MathTypes.h"
+#include <limits>
+
+namespace nc
+{
+	struct AABB
+	{
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ std::numeric_limits<float>::lowest() };
+
+		AABB() {}
+		AABB(const glm::vec3& min, const glm::vec3& max) : min{ min }, max{ max } {}
+
+		// an empty box has no bounds, objects without bounds are never culled
+		bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+		glm::vec3 Center() const { return (min + max) * 0.5f; }
+		glm::vec3 Extents() const { return (max - min) * 0.5f; }
+
+		void Expand(const glm::vec3& point)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		void Expand(const AABB& aabb)
+		{
+			min = glm::min(min, aabb.min);
+			max = glm::max(max, aabb.max);
+		}
+
+		// box around the transformed box (Arvo)
+		AABB Transform(const glm::mat4& mx) const
+		{
+			if (!IsValid()) return *this;
+
+			glm::vec3 center = glm::vec3{ mx * glm::vec4{ Center(), 1 } };
+			glm::vec3 extents = Extents();
+			glm::vec3 worldExtents{ 0 };
+			for (int i = 0; i < 3; i++)
+			{
+				worldExtents += glm::abs(glm::vec3{ mx[i] }) * extents[i];
+			}
+
+			return AABB{ center - worldExtents, center + worldExtents };
+		}
+	};
+
+	struct Sphere
+	{
+		glm::vec3 center{ 0 };
+		float radius{ 0 };
+
+		Sphere() {}
+		Sphere(const glm::vec3& center, float radius) : center{ center }, radius{ radius } {}
+
+		Sphere Transform(const glm::mat4& mx) const
+		{
+			// scale the radius by the largest axis scale
+			float scale = glm::max(glm::length(glm::vec3{ mx[0] }), glm::max(glm::length(glm::vec3{ mx[1] }), glm::length(glm::vec3{ mx[2] })));
+			return Sphere{ glm::vec3{ mx * glm::vec4{ center, 1 } }, radius * scale };
+		}
+	};
+}
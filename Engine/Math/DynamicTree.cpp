@@ -0,0 +1,308 @@
+#include "DynamicTree.h"
+#include <algorithm>
+
+namespace nc
+{
+	DynamicTree::DynamicTree()
+	{
+		Clear();
+	}
+
+	int DynamicTree::CreateProxy(const AABB& aabb, void* userData)
+	{
+		int proxy = AllocateNode();
+
+		glm::vec3 fat{ margin };
+		nodes[proxy].aabb = AABB{ aabb.min - fat, aabb.max + fat };
+		nodes[proxy].userData = userData;
+		nodes[proxy].height = 0;
+
+		InsertLeaf(proxy);
+
+		return proxy;
+	}
+
+	void DynamicTree::DestroyProxy(int proxy)
+	{
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+	}
+
+	bool DynamicTree::MoveProxy(int proxy, const AABB& aabb)
+	{
+		// still inside the fat box, nothing to do
+		const AABB& fatAABB = nodes[proxy].aabb;
+		if (glm::all(glm::lessThanEqual(fatAABB.min, aabb.min)) && glm::all(glm::greaterThanEqual(fatAABB.max, aabb.max))) return false;
+
+		RemoveLeaf(proxy);
+
+		glm::vec3 fat{ margin };
+		nodes[proxy].aabb = AABB{ aabb.min - fat, aabb.max + fat };
+
+		InsertLeaf(proxy);
+
+		return true;
+	}
+
+	void DynamicTree::Clear()
+	{
+		nodes.clear();
+		root = Null;
+		freeList = Null;
+	}
+
+	float DynamicTree::Distance(const AABB& aabb, const glm::vec3& point)
+	{
+		glm::vec3 closest = glm::clamp(point, aabb.min, aabb.max);
+		return glm::distance(closest, point);
+	}
+
+	float DynamicTree::Raycast(const AABB& aabb, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+	{
+		// slab test
+		glm::vec3 t1 = (aabb.min - origin) * inverseDirection;
+		glm::vec3 t2 = (aabb.max - origin) * inverseDirection;
+		glm::vec3 tmin = glm::min(t1, t2);
+		glm::vec3 tmax = glm::max(t1, t2);
+
+		float enter = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.0f));
+		float exit = std::min(std::min(tmax.x, tmax.y), std::min(tmax.z, maxDistance));
+
+		return (enter <= exit) ? enter : -1.0f;
+	}
+
+	int DynamicTree::AllocateNode()
+	{
+		if (freeList == Null)
+		{
+			nodes.emplace_back();
+			nodes.back().next = Null;
+			freeList = (int)nodes.size() - 1;
+		}
+
+		int node = freeList;
+		freeList = nodes[node].next;
+
+		nodes[node].parent = Null;
+		nodes[node].child1 = Null;
+		nodes[node].child2 = Null;
+		nodes[node].height = 0;
+		nodes[node].userData = nullptr;
+
+		return node;
+	}
+
+	void DynamicTree::FreeNode(int node)
+	{
+		nodes[node].next = freeList;
+		nodes[node].height = -1;
+		freeList = node;
+	}
+
+	void DynamicTree::InsertLeaf(int leaf)
+	{
+		if (root == Null)
+		{
+			root = leaf;
+			nodes[root].parent = Null;
+			return;
+		}
+
+		// find the best sibling using the surface area heuristic
+		AABB leafAABB = nodes[leaf].aabb;
+		int index = root;
+		while (!nodes[index].IsLeaf())
+		{
+			int child1 = nodes[index].child1;
+			int child2 = nodes[index].child2;
+
+			float area = Area(nodes[index].aabb);
+
+			AABB combined = nodes[index].aabb;
+			combined.Expand(leafAABB);
+			float combinedArea = Area(combined);
+
+			// cost of creating a new parent for this node and the new leaf
+			float cost = 2.0f * combinedArea;
+			// minimum cost of pushing the leaf further down the tree
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto descendCost = [&](int child)
+			{
+				AABB aabb = nodes[child].aabb;
+				aabb.Expand(leafAABB);
+				float childCost = Area(aabb) + inheritanceCost;
+				if (!nodes[child].IsLeaf()) childCost -= Area(nodes[child].aabb);
+				return childCost;
+			};
+
+			float cost1 = descendCost(child1);
+			float cost2 = descendCost(child2);
+
+			if (cost < cost1 && cost < cost2) break;
+
+			index = (cost1 < cost2) ? child1 : child2;
+		}
+
+		int sibling = index;
+
+		// create a new parent
+		int oldParent = nodes[sibling].parent;
+		int newParent = AllocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].aabb = nodes[sibling].aabb;
+		nodes[newParent].aabb.Expand(leafAABB);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+
+		if (oldParent != Null)
+		{
+			if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+			else nodes[oldParent].child2 = newParent;
+		}
+		else
+		{
+			root = newParent;
+		}
+
+		// walk back up the tree fixing heights and boxes
+		index = nodes[leaf].parent;
+		while (index != Null)
+		{
+			index = Balance(index);
+
+			int child1 = nodes[index].child1;
+			int child2 = nodes[index].child2;
+
+			nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+			nodes[index].aabb = nodes[child1].aabb;
+			nodes[index].aabb.Expand(nodes[child2].aabb);
+
+			index = nodes[index].parent;
+		}
+	}
+
+	void DynamicTree::RemoveLeaf(int leaf)
+	{
+		if (leaf == root)
+		{
+			root = Null;
+			return;
+		}
+
+		int parent = nodes[leaf].parent;
+		int grandParent = nodes[parent].parent;
+		int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grandParent != Null)
+		{
+			// connect the sibling to the grand parent and remove the parent
+			if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+			else nodes[grandParent].child2 = sibling;
+			nodes[sibling].parent = grandParent;
+			FreeNode(parent);
+
+			int index = grandParent;
+			while (index != Null)
+			{
+				index = Balance(index);
+
+				int child1 = nodes[index].child1;
+				int child2 = nodes[index].child2;
+
+				nodes[index].aabb = nodes[child1].aabb;
+				nodes[index].aabb.Expand(nodes[child2].aabb);
+				nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+				index = nodes[index].parent;
+			}
+		}
+		else
+		{
+			root = sibling;
+			nodes[sibling].parent = Null;
+			FreeNode(parent);
+		}
+	}
+
+	int DynamicTree::Balance(int a)
+	{
+		// rotate the higher grand child up if the children of a are unbalanced, returns the new root of the sub tree
+		node_t* A = &nodes[a];
+		if (A->IsLeaf() || A->height < 2) return a;
+
+		int b = A->child1;
+		int c = A->child2;
+		node_t* B = &nodes[b];
+		node_t* C = &nodes[c];
+
+		int balance = C->height - B->height;
+
+		auto rotate = [&](int up, node_t* UP, node_t* STAY, bool upIsChild2)
+		{
+			int f = UP->child1;
+			int g = UP->child2;
+			node_t* F = &nodes[f];
+			node_t* G = &nodes[g];
+
+			// swap a and up
+			UP->child1 = a;
+			UP->parent = A->parent;
+			A->parent = up;
+
+			if (UP->parent != Null)
+			{
+				if (nodes[UP->parent].child1 == a) nodes[UP->parent].child1 = up;
+				else nodes[UP->parent].child2 = up;
+			}
+			else
+			{
+				root = up;
+			}
+
+			// keep the higher grand child under up, move the other one under a
+			int keep = (F->height > G->height) ? f : g;
+			int move = (F->height > G->height) ? g : f;
+			UP->child2 = keep;
+			if (upIsChild2) A->child2 = move;
+			else A->child1 = move;
+			nodes[move].parent = a;
+
+			A->aabb = STAY->aabb;
+			A->aabb.Expand(nodes[move].aabb);
+			UP->aabb = A->aabb;
+			UP->aabb.Expand(nodes[keep].aabb);
+
+			A->height = 1 + std::max(STAY->height, nodes[move].height);
+			UP->height = 1 + std::max(A->height, nodes[keep].height);
+		};
+
+		if (balance > 1)
+		{
+			rotate(c, C, B, true);
+			return c;
+		}
+
+		if (balance < -1)
+		{
+			rotate(b, B, C, false);
+			return b;
+		}
+
+		return a;
+	}
+
+	float DynamicTree::Area(const AABB& aabb)
+	{
+		glm::vec3 d = aabb.max - aabb.min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	bool DynamicTree::Overlaps(const AABB& a, const AABB& b)
+	{
+		return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::greaterThanEqual(a.max, b.min));
+	}
+}
@@ -0,0 +1,235 @@
+#pragma once
+#include "Bounds.h"
+#include "Frustum.h"
+#include <vector>
+#include <queue>
+#include <functional>
+
+namespace nc
+{
+	// dynamic aabb tree, leaves hold fat boxes so small movements do not restructure the tree
+	class DynamicTree
+	{
+	public:
+		static const int Null = -1;
+
+	public:
+		DynamicTree();
+
+		int CreateProxy(const AABB& aabb, void* userData);
+		void DestroyProxy(int proxy);
+		// returns true if the proxy left its fat box and was reinserted
+		bool MoveProxy(int proxy, const AABB& aabb);
+		void Clear();
+
+		void* GetUserData(int proxy) const { return nodes[proxy].userData; }
+		const AABB& GetFatAABB(int proxy) const { return nodes[proxy].aabb; }
+		AABB GetBounds() const { return (root != Null) ? nodes[root].aabb : AABB{}; }
+		int GetHeight() const { return (root != Null) ? nodes[root].height : 0; }
+
+		// callback(int proxy) returns false to stop the query
+		template<typename T>
+		void Query(const AABB& aabb, T callback) const;
+		template<typename T>
+		void Query(const Sphere& sphere, T callback) const;
+		template<typename T>
+		void Query(const Frustum& frustum, T callback) const;
+
+		// callback(int proxy, float distance) returns the new maximum distance, 0 stops the ray
+		template<typename T>
+		void Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, T callback) const;
+
+		// callback(int proxy) returns the exact distance to the object, returns the closest proxy or Null
+		template<typename T>
+		int FindNearest(const glm::vec3& point, float maxDistance, T callback) const;
+
+		static float Distance(const AABB& aabb, const glm::vec3& point);
+		// distance along the ray to the box, negative if the ray misses
+		static float Raycast(const AABB& aabb, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance);
+
+	private:
+		struct node_t
+		{
+			AABB aabb;
+			void* userData{ nullptr };
+			union
+			{
+				int parent;
+				int next;
+			};
+			int child1{ Null };
+			int child2{ Null };
+			// leaf = 0, free node = -1
+			int height{ -1 };
+
+			bool IsLeaf() const { return child1 == Null; }
+		};
+
+		int AllocateNode();
+		void FreeNode(int node);
+		void InsertLeaf(int leaf);
+		void RemoveLeaf(int leaf);
+		int Balance(int node);
+
+		static float Area(const AABB& aabb);
+		static bool Overlaps(const AABB& a, const AABB& b);
+
+	private:
+		std::vector<node_t> nodes;
+		int root{ Null };
+		int freeList{ Null };
+
+		// fat box margin added around each proxy
+		float margin{ 0.1f };
+	};
+
+	template<typename T>
+	inline void DynamicTree::Query(const AABB& aabb, T callback) const
+	{
+		if (root == Null) return;
+
+		std::vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			int index = stack.back();
+			stack.pop_back();
+
+			const node_t& node = nodes[index];
+			if (!Overlaps(node.aabb, aabb)) continue;
+
+			if (node.IsLeaf())
+			{
+				if (!callback(index)) return;
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	template<typename T>
+	inline void DynamicTree::Query(const Sphere& sphere, T callback) const
+	{
+		if (root == Null) return;
+
+		std::vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			int index = stack.back();
+			stack.pop_back();
+
+			const node_t& node = nodes[index];
+			if (Distance(node.aabb, sphere.center) > sphere.radius) continue;
+
+			if (node.IsLeaf())
+			{
+				if (!callback(index)) return;
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	template<typename T>
+	inline void DynamicTree::Query(const Frustum& frustum, T callback) const
+	{
+		if (root == Null) return;
+
+		std::vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			int index = stack.back();
+			stack.pop_back();
+
+			const node_t& node = nodes[index];
+			if (!frustum.Intersects(node.aabb)) continue;
+
+			if (node.IsLeaf())
+			{
+				if (!callback(index)) return;
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	template<typename T>
+	inline void DynamicTree::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, T callback) const
+	{
+		if (root == Null) return;
+
+		glm::vec3 inverseDirection = 1.0f / direction;
+
+		std::vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			int index = stack.back();
+			stack.pop_back();
+
+			const node_t& node = nodes[index];
+			if (Raycast(node.aabb, origin, inverseDirection, maxDistance) < 0) continue;
+
+			if (node.IsLeaf())
+			{
+				float distance = Raycast(node.aabb, origin, inverseDirection, maxDistance);
+				maxDistance = callback(index, distance);
+				if (maxDistance <= 0) return;
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	template<typename T>
+	inline int DynamicTree::FindNearest(const glm::vec3& point, float maxDistance, T callback) const
+	{
+		if (root == Null) return Null;
+
+		// best first search, nodes are visited in order of their distance to the point
+		using entry_t = std::pair<float, int>;
+		std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> open;
+		open.push({ Distance(nodes[root].aabb, point), root });
+
+		int nearest = Null;
+		while (!open.empty())
+		{
+			entry_t entry = open.top();
+			open.pop();
+
+			if (entry.first > maxDistance) break;
+
+			const node_t& node = nodes[entry.second];
+			if (node.IsLeaf())
+			{
+				float distance = callback(entry.second);
+				if (distance < maxDistance)
+				{
+					maxDistance = distance;
+					nearest = entry.second;
+				}
+			}
+			else
+			{
+				open.push({ Distance(nodes[node.child1].aabb, point), node.child1 });
+				open.push({ Distance(nodes[node.child2].aabb, point), node.child2 });
+			}
+		}
+
+		return nearest;
+	}
+}
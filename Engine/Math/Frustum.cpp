@@ -0,0 +1,104 @@
+#include "Frustum.h"
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define NC_FRUSTUM_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace nc
+{
+	Frustum::Frustum(const glm::mat4& viewProjection)
+	{
+		// extract the planes from the rows of the view projection matrix (Gribb/Hartmann)
+		glm::mat4 mx = glm::transpose(viewProjection);
+
+		planes[0] = mx[3] + mx[0]; // left
+		planes[1] = mx[3] - mx[0]; // right
+		planes[2] = mx[3] + mx[1]; // bottom
+		planes[3] = mx[3] - mx[1]; // top
+		planes[4] = mx[3] + mx[2]; // near
+		planes[5] = mx[3] - mx[2]; // far
+
+		for (auto& plane : planes)
+		{
+			plane /= glm::length(glm::vec3{ plane });
+		}
+	}
+
+	bool Frustum::Intersects(const AABB& aabb) const
+	{
+		if (!aabb.IsValid()) return true;
+
+		glm::vec3 center = aabb.Center();
+		glm::vec3 extents = aabb.Extents();
+		for (auto& plane : planes)
+		{
+			glm::vec3 normal{ plane };
+			float distance = glm::dot(normal, center) + plane.w;
+			float radius = glm::dot(glm::abs(normal), extents);
+			if (distance + radius < 0) return false;
+		}
+
+		return true;
+	}
+
+	bool Frustum::Intersects(const Sphere& sphere) const
+	{
+		for (auto& plane : planes)
+		{
+			if (glm::dot(glm::vec3{ plane }, sphere.center) + plane.w + sphere.radius < 0) return false;
+		}
+
+		return true;
+	}
+
+	void Frustum::Cull(const float* cx, const float* cy, const float* cz, const float* ex, const float* ey, const float* ez, size_t count, uint8_t* visible) const
+	{
+		size_t i = 0;
+
+#ifdef NC_FRUSTUM_SSE
+		// four boxes against one plane at a time
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(cx + i);
+			__m128 y = _mm_loadu_ps(cy + i);
+			__m128 z = _mm_loadu_ps(cz + i);
+			__m128 rx = _mm_loadu_ps(ex + i);
+			__m128 ry = _mm_loadu_ps(ey + i);
+			__m128 rz = _mm_loadu_ps(ez + i);
+
+			__m128 outside = zero;
+			for (auto& plane : planes)
+			{
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))), _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, _mm_set1_ps(std::abs(plane.x))), _mm_mul_ps(ry, _mm_set1_ps(std::abs(plane.y)))), _mm_mul_ps(rz, _mm_set1_ps(std::abs(plane.z))));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+			}
+
+			int mask = _mm_movemask_ps(outside);
+			visible[i + 0] = !(mask & 1);
+			visible[i + 1] = !(mask & 2);
+			visible[i + 2] = !(mask & 4);
+			visible[i + 3] = !(mask & 8);
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			bool inside = true;
+			for (auto& plane : planes)
+			{
+				float distance = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w;
+				float radius = std::abs(plane.x) * ex[i] + std::abs(plane.y) * ey[i] + std::abs(plane.z) * ez[i];
+				if (distance + radius < 0)
+				{
+					inside = false;
+					break;
+				}
+			}
+			visible[i] = inside;
+		}
+	}
+}
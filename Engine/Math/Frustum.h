@@ -0,0 +1,23 @@
+#pragma once
+#include "Bounds.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace nc
+{
+	struct Frustum
+	{
+		// plane normals point inside, a point p is inside a plane when dot(n, p) + d >= 0
+		glm::vec4 planes[6];
+
+		// a default frustum has zero planes and contains everything
+		Frustum() { for (auto& plane : planes) plane = glm::vec4{ 0 }; }
+		Frustum(const glm::mat4& viewProjection);
+
+		bool Intersects(const AABB& aabb) const;
+		bool Intersects(const Sphere& sphere) const;
+
+		// test count boxes stored as arrays of centers and extents, visible[i] is set to 1 if the box intersects
+		void Cull(const float* cx, const float* cy, const float* cz, const float* ex, const float* ey, const float* ez, size_t count, uint8_t* visible) const;
+	};
+}
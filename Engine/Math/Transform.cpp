@@ -4,19 +4,25 @@ namespace nc
 {
 	void Transform::Update()
 	{
+		glm::mat4 previous = matrix;
+
 		glm::mat4 mxt = glm::translate(position);
 		glm::mat4 mxr = glm::eulerAngleYXZ(rotation.y, rotation.x, rotation.z);
 		glm::mat4 mxs = glm::scale(scale);
 
 		matrix = mxt * mxr * mxs;
+		changed = (matrix != previous);
 	}
 
 	void Transform::Update(const glm::mat4& mx)
 	{
+		glm::mat4 previous = matrix;
+
 		Update();
 
 		// multiply matrix by parent matrix
 		matrix = mx * matrix;
+		changed = (matrix != previous);
 	}
 
 	bool Transform::Write(const rapidjson::Value& value) const
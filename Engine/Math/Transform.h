@@ -15,6 +15,8 @@ namespace nc
 		glm::vec3 localScale{ 1 };
 
 		glm::mat4 matrix{ 1 };
+		// set by Update when the matrix differs from the previous update
+		bool changed{ true };
 
 		Transform() {}
 		Transform(const glm::vec3& position, const glm::vec3& rotation = glm::vec3{ 0 }, const glm::vec3& scale = glm::vec3{ 1 }) :
@@ -6,6 +6,20 @@
 
 namespace nc
 {
+	namespace
+	{
+		bool IsLoading(Actor* actor)
+		{
+			for (auto& component : actor->components)
+			{
+				auto modelComponent = dynamic_cast<ModelComponent*>(component.get());
+				if (modelComponent && modelComponent->model && !modelComponent->model->IsReady()) return true;
+			}
+
+			return std::any_of(actor->children.begin(), actor->children.end(), [](auto& child) { return IsLoading(child.get()); });
+		}
+	}
+
 	Actor::Actor(const Actor& other)
 	{
 		tag = other.tag;
@@ -29,7 +43,12 @@ namespace nc
 		std::for_each(components.begin(), components.end(), [](auto& component) { component->Update(); });
 
 		transform.Update();
-		std::for_each(children.begin(), children.end(), [](auto& child) { child->transform.Update(child->parent->transform.matrix); });
+		if (transform.changed) boundsDirty = true;
+		std::for_each(children.begin(), children.end(), [this](auto& child)
+			{
+				child->transform.Update(child->parent->transform.matrix);
+				if (child->transform.changed) boundsDirty = true;
+			});
 	}
 
 	void Actor::Draw(Renderer* renderer)
@@ -46,6 +65,49 @@ namespace nc
 		std::for_each(children.begin(), children.end(), [renderer](auto& child) { child->Draw(renderer); });
 	}
 
+	AABB Actor::GetBounds()
+	{
+		AABB aabb;
+
+		auto modelComponent = GetComponent<ModelComponent>();
+		if (modelComponent != nullptr && modelComponent->model && modelComponent->model->IsReady())
+		{
+			aabb.Expand(modelComponent->model->bounds.Transform(transform.matrix));
+		}
+
+		for (auto& child : children)
+		{
+			AABB childAABB = child->GetBounds();
+			if (childAABB.IsValid()) aabb.Expand(childAABB);
+		}
+
+		return aabb;
+	}
+
+	bool Actor::HasBounds()
+	{
+		for (auto& component : components)
+		{
+			if (dynamic_cast<GraphicsComponent*>(component.get()) == nullptr) continue;
+
+			// only models know their bounds
+			auto modelComponent = dynamic_cast<ModelComponent*>(component.get());
+			if (modelComponent == nullptr || !modelComponent->model || !modelComponent->model->IsReady()) return false;
+		}
+
+		return std::all_of(children.begin(), children.end(), [](auto& child) { return child->HasBounds(); });
+	}
+
+	void Actor::UpdateBounds()
+	{
+		bounds = GetBounds();
+		unbounded = !HasBounds() || !bounds.IsValid();
+		boundsDirty = false;
+
+		// a model that finishes loading does not touch the transform, keep checking until it is ready
+		boundsPending = unbounded && IsLoading(this);
+	}
+
 	void Actor::Intitialize()
 	{
 	}
@@ -96,6 +158,7 @@ namespace nc
 	{
 		component->owner = this;
 		components.push_back(std::move(component));
+		boundsDirty = true;
 	}
 
 	bool Actor::Write(const rapidjson::Value& value) const
@@ -3,6 +3,7 @@
 #include "Scene.h"
 #include "Component/Component.h"
 #include "Math/Transform.h"
+#include "Math/Bounds.h"
 #include "Core/Serializable.h"
 #include <memory>
 #include <vector>
@@ -30,6 +31,13 @@ namespace nc
 
 		void AddChild(std::unique_ptr<Actor> actor);
 
+		// world bounds of the models of the actor and its children, invalid if there are none
+		AABB GetBounds();
+		// false if the actor or a child has graphics without bounds (meshes, models still loading)
+		bool HasBounds();
+		// refreshes bounds and unbounded, called by the scene when the actor is dirty or waiting for a model
+		void UpdateBounds();
+
 		bool hasTag(std::string checkTag);
 		void addTag(std::string tag);
 
@@ -59,6 +67,16 @@ namespace nc
 		std::vector<std::unique_ptr<Actor>> children;
 		unsigned int id = 0;
 
+		// spatial index proxy and the bounds it was last updated with
+		int proxy{ -1 };
+		AABB bounds;
+		// actors without bounds are not in the spatial index, they are drawn every frame instead of culled
+		bool unbounded{ false };
+		// set when the transform of the actor or a child changed or a component was added
+		bool boundsDirty{ true };
+		// a model is still loading, the bounds are refreshed every update until it is ready
+		bool boundsPending{ false };
+
 		std::vector<std::unique_ptr<Component>> components;
 	};
 	
@@ -69,6 +87,7 @@ namespace nc
 		component->owner = this;
 
 		components.push_back(move(component));
+		boundsDirty = true;
 
 		return dynamic_cast<T*>(components.back().get());
 	}
@@ -20,12 +20,96 @@ namespace nc
 		{
 			if ((*iter)->destroy)
 			{
+				Actor* actor = iter->get();
+				if (actor->proxy != DynamicTree::Null) tree.DestroyProxy(actor->proxy);
+				for (auto contact = contacts.begin(); contact != contacts.end();)
+				{
+					if (contact->first == actor || contact->second == actor) contact = contacts.erase(contact);
+					else contact++;
+				}
+
 				iter = actors.erase(iter);
 			}
 			else {
 				iter++;
 			}
 		}
+
+		UpdateSpatialIndex();
+		UpdateContacts();
+	}
+
+	void Scene::UpdateSpatialIndex()
+	{
+		unbounded.clear();
+		for (auto& actor : actors)
+		{
+			// only actors that moved or are waiting for a model are refit
+			if (actor->boundsDirty || actor->boundsPending)
+			{
+				actor->UpdateBounds();
+				if (actor->unbounded)
+				{
+					// a point at the actor position would cull graphics that are still on screen
+					if (actor->proxy != DynamicTree::Null) tree.DestroyProxy(actor->proxy);
+					actor->proxy = DynamicTree::Null;
+				}
+				else if (actor->proxy == DynamicTree::Null)
+				{
+					actor->proxy = tree.CreateProxy(actor->bounds, actor.get());
+				}
+				else
+				{
+					// only restructures the tree when the actor leaves its fat box
+					tree.MoveProxy(actor->proxy, actor->bounds);
+				}
+			}
+
+			if (actor->unbounded) unbounded.push_back(actor.get());
+		}
+	}
+
+	void Scene::UpdateContacts()
+	{
+		// only physics actors generate contacts, pair them against everything they overlap
+		std::set<std::pair<Actor*, Actor*>> current;
+		for (auto& actor : actors)
+		{
+			if (!actor->active || actor->GetComponent<PhysicsComponent>() == nullptr) continue;
+
+			Actor* self = actor.get();
+			tree.Query(self->bounds, [this, self, &current](int proxy)
+				{
+					Actor* other = static_cast<Actor*>(tree.GetUserData(proxy));
+					if (other != self && other->active &&
+						glm::all(glm::lessThanEqual(self->bounds.min, other->bounds.max)) &&
+						glm::all(glm::greaterThanEqual(self->bounds.max, other->bounds.min)))
+					{
+						current.insert(std::minmax(self, other));
+					}
+					return true;
+				});
+		}
+
+		for (auto& pair : current)
+		{
+			if (contacts.find(pair) == contacts.end())
+			{
+				pair.first->BeginContact(pair.second);
+				pair.second->BeginContact(pair.first);
+			}
+		}
+
+		for (auto& pair : contacts)
+		{
+			if (current.find(pair) == current.end())
+			{
+				pair.first->EndContact(pair.second);
+				pair.second->EndContact(pair.first);
+			}
+		}
+
+		contacts.swap(current);
 	}
 
 	bool Scene::Write(const rapidjson::Value& value) const
@@ -69,7 +153,26 @@ namespace nc
 
 	void Scene::Draw(Renderer* renderer)
 	{
-		std::for_each(actors.begin(), actors.end(), [renderer](auto& actor) { actor->Draw(renderer); });
+		// camera matrices are computed once per frame and shared by every draw
+		// without a camera the identity frame draws in clip space, the queue still drops the packets of the last frame
+		renderer->queue.Begin((activeCamera != nullptr) ? activeCamera->GetFrame() : RenderQueue::frame_t{});
+
+		// actors submit their draws to the render queue, the queue sorts them by state and draws
+		if (activeCamera != nullptr)
+		{
+			// only actors the spatial index finds in the camera frustum are drawn, actors without bounds always are
+			tree.Query(activeCamera->GetFrustum(), [this, renderer](int proxy)
+				{
+					static_cast<Actor*>(tree.GetUserData(proxy))->Draw(renderer);
+					return true;
+				});
+			std::for_each(unbounded.begin(), unbounded.end(), [renderer](Actor* actor) { actor->Draw(renderer); });
+		}
+		else
+		{
+			std::for_each(actors.begin(), actors.end(), [renderer](auto& actor) { actor->Draw(renderer); });
+		}
+		renderer->queue.Flush();
 	}
 
 	void Scene::AddActor(std::unique_ptr<Actor> actor)
@@ -89,6 +192,9 @@ namespace nc
 	void Scene::RemoveAllActors()
 	{
 		actors.clear();
+		tree.Clear();
+		unbounded.clear();
+		contacts.clear();
 	}
 
 	void Scene::RemoveByTag(const std::string& tag)
@@ -113,6 +219,82 @@ namespace nc
 		return nullptr;
 	}
 
+	std::vector<Actor*> Scene::Query(const Frustum& frustum)
+	{
+		std::vector<Actor*> result;
+		tree.Query(frustum, [this, &frustum, &result](int proxy)
+			{
+				Actor* actor = static_cast<Actor*>(tree.GetUserData(proxy));
+				if (frustum.Intersects(actor->bounds)) result.push_back(actor);
+				return true;
+			});
+
+		return result;
+	}
+
+	std::vector<Actor*> Scene::Query(const Sphere& sphere)
+	{
+		std::vector<Actor*> result;
+		tree.Query(sphere, [this, &sphere, &result](int proxy)
+			{
+				Actor* actor = static_cast<Actor*>(tree.GetUserData(proxy));
+				if (DynamicTree::Distance(actor->bounds, sphere.center) <= sphere.radius) result.push_back(actor);
+				return true;
+			});
+
+		return result;
+	}
+
+	Actor* Scene::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* distance)
+	{
+		Actor* hit = nullptr;
+		float hitDistance = maxDistance;
+		glm::vec3 inverseDirection = 1.0f / direction;
+
+		tree.Raycast(origin, direction, maxDistance, [this, &origin, &inverseDirection, &hit, &hitDistance](int proxy, float)
+			{
+				Actor* actor = static_cast<Actor*>(tree.GetUserData(proxy));
+				float d = DynamicTree::Raycast(actor->bounds, origin, inverseDirection, hitDistance);
+				if (d >= 0 && d < hitDistance)
+				{
+					hit = actor;
+					hitDistance = d;
+				}
+				// clip the ray to the closest hit so far
+				return hitDistance;
+			});
+
+		if (hit != nullptr && distance != nullptr) *distance = hitDistance;
+
+		return hit;
+	}
+
+	Actor* Scene::FindNearest(const glm::vec3& point, float maxDistance)
+	{
+		int proxy = tree.FindNearest(point, maxDistance, [this, &point](int proxy)
+			{
+				return DynamicTree::Distance(static_cast<Actor*>(tree.GetUserData(proxy))->bounds, point);
+			});
+
+		return (proxy != DynamicTree::Null) ? static_cast<Actor*>(tree.GetUserData(proxy)) : nullptr;
+	}
+
+	glm::vec3 Scene::SafeLocation(float radius, float buffer)
+	{
+		// random locations inside the scene bounds until one is clear of every actor
+		AABB area = tree.GetBounds();
+		if (!area.IsValid()) return glm::vec3{ 0 };
+
+		glm::vec3 location{ 0 };
+		for (int i = 0; i < 32; i++)
+		{
+			location = glm::vec3{ RandomRange(area.min.x, area.max.x), RandomRange(area.min.y, area.max.y), RandomRange(area.min.z, area.max.z) };
+			if (Query(Sphere{ location, radius + buffer }).empty()) break;
+		}
+
+		return location;
+	}
+
 	int Scene::ActorCount()
 	{
 		return actors.size();
@@ -1,10 +1,12 @@
 #pragma once
 #include "Object.h"
 #include "../Math/MathTypes.h"
+#include "Math/DynamicTree.h"
 #include "Core/Serializable.h"
 #include <list>
 #include <memory>
 #include <vector>
+#include <set>
 #include <string>
 
 namespace nc
@@ -15,6 +17,8 @@ namespace nc
 
 	class Renderer;
 
+	class CameraComponent;
+
 	class Scene : public Object, public ISerializable
 	{
 	public:
@@ -29,6 +33,15 @@ namespace nc
 
 		Actor* FindActor(const std::string& name);
 
+		// spatial queries, answered by the dynamic aabb tree of the scene actors, actors without bounds are not found
+		std::vector<Actor*> Query(const Frustum& frustum);
+		std::vector<Actor*> Query(const Sphere& sphere);
+		Actor* Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* distance = nullptr);
+		Actor* FindNearest(const glm::vec3& point, float maxDistance);
+
+		void SetActiveCamera(CameraComponent* camera) { activeCamera = camera; }
+		CameraComponent* GetActiveCamera() { return activeCamera; }
+
 		template<typename T>
 		T* GetActor();
 
@@ -41,6 +54,10 @@ namespace nc
 		virtual bool Write(const rapidjson::Value& value) const override;
 		virtual bool Read(const rapidjson::Value& value) override;
 
+	private:
+		void UpdateSpatialIndex();
+		void UpdateContacts();
+
 	public:
 		Engine* engine{ nullptr };
 		unsigned int id = 0;
@@ -49,6 +66,14 @@ namespace nc
 		std::vector<std::unique_ptr<Actor>> actors;
 		std::vector<std::unique_ptr<Actor>> newActors;
 
+		DynamicTree tree;
+		// actors left out of the tree, rebuilt with it every update
+		std::vector<Actor*> unbounded;
+		std::set<std::pair<Actor*, Actor*>> contacts;
+
+		// registered by the camera component, avoids searching the actors every draw
+		CameraComponent* activeCamera{ nullptr };
+
 		//Makes the distance between actors calculate larger, so they can get closer before colliding.
 		float collisionGive = 2.0f;
 	};
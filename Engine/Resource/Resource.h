@@ -1,4 +1,5 @@
 #pragma once
+#include "ResourceId.h"
 #include <string>
 
 namespace nc
@@ -6,6 +7,28 @@ namespace nc
 	class Resource
 	{
 	public:
+		virtual ~Resource() {}
+
 		virtual bool Load(const std::string& filename, void* data = nullptr) = 0;
+
+		// asynchronous loading, Decode runs on a worker thread (file io and parsing, no gl calls)
+		// and Upload runs on the render thread, resources that do not split their load do it all in Upload
+		virtual bool Decode(const std::string& filename, void* data) { return true; }
+		virtual bool Upload(const std::string& filename, void* data) { return Load(filename, data); }
+
+		bool IsReady() const { return ready; }
+
+		// hot reload decodes and uploads a changed file again into the same resource, in use resources that cannot change in place return false
+		virtual bool CanReload() const { return false; }
+		// resources built from other resources reload after the resource they depend on
+		virtual bool DependsOn(ResourceId id) const { return false; }
+
+		// memory held by the resource, used for the resource system budget
+		virtual size_t GetGpuBytes() const { return 0; }
+		virtual size_t GetCpuBytes() const { return 0; }
+
+	private:
+		friend class ResourceSystem;
+		bool ready{ false };
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Core/Hash.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace nc
+{
+	// case insensitive 64 bit fnv-1a hash of a resource name, can be computed at compile time
+	struct ResourceId
+	{
+		uint64_t hash{ 0 };
+
+		constexpr ResourceId() {}
+		constexpr ResourceId(std::string_view name) : hash{ Hash(name) } {}
+		constexpr ResourceId(const char* name) : ResourceId{ std::string_view{ name } } {}
+		ResourceId(const std::string& name) : ResourceId{ std::string_view{ name } } {}
+
+		constexpr bool IsValid() const { return hash != 0; }
+
+		constexpr bool operator == (const ResourceId& other) const { return hash == other.hash; }
+		constexpr bool operator != (const ResourceId& other) const { return hash != other.hash; }
+
+		static constexpr uint64_t Hash(std::string_view name)
+		{
+			uint64_t hash = HashOffset;
+			for (char c : name)
+			{
+				// fold ascii upper case to lower case
+				if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+				hash = hash_byte((uint8_t)c, hash);
+			}
+			return hash;
+		}
+	};
+}
@@ -0,0 +1,283 @@
+#include "ResourceSystem.h"
+#include <SDL.h>
+#include <chrono>
+
+namespace nc
+{
+	void ResourceSystem::Startup()
+	{
+		pool.Startup();
+	}
+
+	void ResourceSystem::Shutdown()
+	{
+		watcher.Shutdown();
+
+		// finish what is in flight so no worker touches a released resource
+		pool.Shutdown();
+		pending.clear();
+		resources.Clear();
+		sources.Clear();
+		recent.clear();
+		buckets.clear();
+	}
+
+	void ResourceSystem::Update(float dt)
+	{
+		// changed files are queued like asynchronous loads
+		if (watcher.IsWatching())
+		{
+			for (auto& name : watcher.Poll())
+			{
+				Reload(name);
+			}
+		}
+
+		using clock = std::chrono::steady_clock;
+		clock::time_point start = clock::now();
+
+		for (auto iter = pending.begin(); iter != pending.end();)
+		{
+			// resources are uploaded in request order as their decode completes
+			if (iter->decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				iter++;
+				continue;
+			}
+
+			iter = Complete(iter);
+
+			if (std::chrono::duration<float>(clock::now() - start).count() >= uploadBudget) break;
+		}
+
+		if (memoryBudget && usage.gpuBytes + usage.cpuBytes > memoryBudget) Evict();
+	}
+
+	void ResourceSystem::UpdateUsage(ResourceId id)
+	{
+		entry_t* entry = resources.Find(id);
+		if (entry && entry->resource->IsReady()) Account(*entry);
+	}
+
+	bool ResourceSystem::WatchFiles(const std::string& directory)
+	{
+		return watcher.Startup(directory);
+	}
+
+	void ResourceSystem::Reload(const std::string& name)
+	{
+		ReloadEntry(ResourceId{ name });
+	}
+
+	void ResourceSystem::ReloadEntry(ResourceId id)
+	{
+		// a file that is not a loaded resource can still be read by resources that depend on it (shader variants)
+		entry_t* entry = resources.Find(id);
+		if (entry == nullptr)
+		{
+			ReloadDependents(id);
+			return;
+		}
+		// loaded before the watch started, the name to decode it from is not known
+		source_t* source = sources.Find(id);
+		if (source == nullptr || !entry->resource->IsReady() || !entry->resource->CanReload()) return;
+
+		// one reload at a time, decodes of the same resource must not overlap
+		// a change during the decode is picked up by reloading again after it
+		auto iter = std::find_if(pending.begin(), pending.end(), [id](const pending_t& pending) { return pending.id == id; });
+		if (iter != pending.end())
+		{
+			iter->dirty = true;
+			return;
+		}
+
+		std::shared_ptr<Resource> resource = entry->resource;
+		void* data = source->data;
+
+		pending_t job;
+		job.id = id;
+		job.name = source->name;
+		job.resource = resource;
+		job.data = data;
+		job.reload = true;
+		job.decoded = pool.Enqueue([resource, name = source->name, data]() { return resource->Decode(name, data); });
+		pending.push_back(std::move(job));
+	}
+
+	ResourceSystem::entry_t* ResourceSystem::FindEntry(ResourceId id, std::string_view name)
+	{
+		entry_t* entry = resources.Find(id);
+#ifdef _DEBUG
+		if (entry && !istring_compare(entry->name, std::string{ name })) SDL_Log("Resource id collision (%s, %.*s).", entry->name.c_str(), (int)name.size(), name.data());
+#endif
+		return entry;
+	}
+
+	void ResourceSystem::AddEntry(ResourceId id, const std::string& name, std::shared_ptr<Resource> resource, size_t type, void* data)
+	{
+		// a replaced entry leaves its bucket first
+		RemoveEntry(id);
+
+		// a new resource type gets its bucket here
+		if (type >= buckets.size()) buckets.resize(type + 1);
+		bucket_t& bucket = buckets[type];
+
+		entry_t entry;
+		entry.resource = resource;
+		entry.type = type;
+		entry.slot = bucket.resources.size();
+		entry.recent = recent.insert(recent.begin(), id);
+#ifdef _DEBUG
+		entry.name = name;
+#endif
+		resources.Insert(id, std::move(entry));
+		if (watcher.IsWatching()) sources.Insert(id, source_t{ name, data });
+
+		bucket.resources.push_back(resource);
+		bucket.ids.push_back(id);
+		bucket.usage.count++;
+		usage.count++;
+	}
+
+	void ResourceSystem::RemoveEntry(ResourceId id)
+	{
+		entry_t* entry = resources.Find(id);
+		if (entry == nullptr) return;
+
+		// move the last resource of the bucket into the removed slot
+		bucket_t& bucket = buckets[entry->type];
+		size_t last = bucket.resources.size() - 1;
+		if (entry->slot != last)
+		{
+			bucket.resources[entry->slot] = std::move(bucket.resources[last]);
+			bucket.ids[entry->slot] = bucket.ids[last];
+			resources.Find(bucket.ids[entry->slot])->slot = entry->slot;
+		}
+		bucket.resources.pop_back();
+		bucket.ids.pop_back();
+
+		bucket.usage.gpuBytes -= entry->gpuBytes;
+		bucket.usage.cpuBytes -= entry->cpuBytes;
+		bucket.usage.count--;
+		usage.gpuBytes -= entry->gpuBytes;
+		usage.cpuBytes -= entry->cpuBytes;
+		usage.count--;
+
+		recent.erase(entry->recent);
+		resources.Remove(id);
+		sources.Remove(id);
+	}
+
+	void ResourceSystem::Account(entry_t& entry)
+	{
+		size_t gpuBytes = entry.resource->GetGpuBytes();
+		size_t cpuBytes = entry.resource->GetCpuBytes();
+
+		usage_t& bucketUsage = buckets[entry.type].usage;
+		bucketUsage.gpuBytes += gpuBytes - entry.gpuBytes;
+		bucketUsage.cpuBytes += cpuBytes - entry.cpuBytes;
+		usage.gpuBytes += gpuBytes - entry.gpuBytes;
+		usage.cpuBytes += cpuBytes - entry.cpuBytes;
+
+		entry.gpuBytes = gpuBytes;
+		entry.cpuBytes = cpuBytes;
+	}
+
+	void ResourceSystem::Evict()
+	{
+		// resources nothing else references, least recently used first
+		// the entry and the type bucket hold the only references of an unused resource
+		// resources without accounted memory are evicted too, an unused material releases its textures for the next pass
+		const long CacheReferences = 2;
+		auto iter = recent.end();
+		while (iter != recent.begin() && usage.gpuBytes + usage.cpuBytes > memoryBudget)
+		{
+			iter--;
+			entry_t* entry = resources.Find(*iter);
+			if (entry->resource.use_count() == CacheReferences && entry->resource->IsReady())
+			{
+				// step past the entry before its list node is erased
+				ResourceId id = *iter++;
+				RemoveEntry(id);
+			}
+		}
+	}
+
+	void ResourceSystem::Finish(ResourceId id)
+	{
+		auto iter = std::find_if(pending.begin(), pending.end(), [id](const pending_t& pending) { return pending.id == id; });
+		if (iter == pending.end()) return;
+
+		Complete(iter);
+	}
+
+	std::list<ResourceSystem::pending_t>::iterator ResourceSystem::Complete(std::list<pending_t>::iterator iter)
+	{
+		Upload(*iter);
+
+		// queued after the erase, a reload of an id still pending would only be marked dirty
+		bool dirty = iter->dirty;
+		ResourceId id = iter->id;
+		iter = pending.erase(iter);
+		if (dirty) ReloadEntry(id);
+
+		return iter;
+	}
+
+	void ResourceSystem::Upload(pending_t& pending)
+	{
+		if (pending.reload)
+		{
+			Reloaded(pending);
+			return;
+		}
+
+		if (pending.decoded.get())
+		{
+			if (!pending.resource->Upload(pending.name, pending.data))
+			{
+				SDL_Log("Could not upload resource (%s).", pending.name.c_str());
+			}
+		}
+		else
+		{
+			SDL_Log("Could not decode resource (%s).", pending.name.c_str());
+		}
+
+		// failed resources are marked ready too, as a failed synchronous load would be
+		pending.resource->ready = true;
+
+		entry_t* entry = resources.Find(pending.id);
+		if (entry) Account(*entry);
+	}
+
+	void ResourceSystem::Reloaded(pending_t& pending)
+	{
+		// the resource keeps what it had if the new file does not decode or upload
+		if (!pending.decoded.get() || !pending.resource->Upload(pending.name, pending.data))
+		{
+			SDL_Log("Could not reload resource (%s).", pending.name.c_str());
+			return;
+		}
+		SDL_Log("Reloaded resource (%s).", pending.name.c_str());
+
+		UpdateUsage(pending.id);
+
+		ReloadDependents(pending.id);
+	}
+
+	void ResourceSystem::ReloadDependents(ResourceId id)
+	{
+		// programs are linked again after one of their shaders changes
+		std::vector<ResourceId> dependents;
+		resources.ForEach([&dependents, id](ResourceId dependent, entry_t& entry)
+		{
+			if (entry.resource->IsReady() && entry.resource->DependsOn(id)) dependents.push_back(dependent);
+		});
+
+		for (auto& dependent : dependents)
+		{
+			ReloadEntry(dependent);
+		}
+	}
+}
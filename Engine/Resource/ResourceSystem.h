@@ -1,51 +1,249 @@
 #pragma once
 #include "Framework/System.h"
+#include "Framework/ThreadPool.h"
 #include "Resource.h"
+#include "ResourceId.h"
+#include "Core/HashTable.h"
+#include "Core/FileWatcher.h"
+#include "Core/Utilities.h"
+#include <SDL.h>
 #include <string>
-#include <map>
+#include <string_view>
 #include <memory>
 #include <algorithm>
+#include <future>
+#include <list>
 
 namespace nc
 {
+	// unique index for each resource type, assigned on first use
+	inline size_t NextTypeIndex()
+	{
+		static size_t next = 0;
+		return next++;
+	}
+
+	template <typename T>
+	size_t TypeIndex()
+	{
+		static const size_t index = NextTypeIndex();
+		return index;
+	}
+
 	class ResourceSystem : public System
 	{
 	public:
-		void Startup() override {}
-		void Shutdown() override {}
-		void Update(float dt) override {}
+		void Startup() override;
+		void Shutdown() override;
+		// uploads decoded resources until the upload budget is spent
+		void Update(float dt) override;
 
+		// a hit neither allocates nor copies the name, only a load does
+		template <typename T>
+		std::shared_ptr<T> Get(std::string_view name, void* data = nullptr) { return Get<T>(ResourceId{ name }, name, data); }
+		// id is the ResourceId of name, precomputed by callers that request the same resource repeatedly
 		template <typename T>
-		std::shared_ptr<T> Get(const std::string& name, void* data = nullptr);
+		std::shared_ptr<T> Get(ResourceId id, std::string_view name, void* data = nullptr);
+		// lookup only, nullptr if the resource was never requested
+		template <typename T>
+		std::shared_ptr<T> Find(ResourceId id);
+		// returns the resource at once, it is decoded on a worker thread and uploaded in a later Update (IsReady)
+		// the data pointer must stay valid until the resource is ready
+		template <typename T>
+		std::shared_ptr<T> GetAsync(std::string_view name, void* data = nullptr) { return GetAsync<T>(ResourceId{ name }, name, data); }
+		template <typename T>
+		std::shared_ptr<T> GetAsync(ResourceId id, std::string_view name, void* data = nullptr);
+		// all resources of type T, read from the bucket of the type
 		template <typename T>
 		std::vector<std::shared_ptr<T>> Get();
+		// function(T& resource) for every resource of type T
+		template <typename T, typename F>
+		void ForEach(F function);
+
+		template <typename T>
+		void Add(const std::string& name, std::shared_ptr<T> resource);
+
+		// seconds of uploads per frame, at least one upload is done every frame
+		void SetUploadBudget(float seconds) { uploadBudget = seconds; }
+		size_t GetPendingCount() const { return pending.size(); }
 
-		void Add(const std::string& name, std::shared_ptr<nc::Resource> resource);
+		struct usage_t
+		{
+			size_t gpuBytes{ 0 };
+			size_t cpuBytes{ 0 };
+			size_t count{ 0 };
+		};
+
+		// bytes of gpu and cpu memory allowed before unused resources are evicted, 0 is unlimited
+		// resources only referenced by the resource system are evicted least recently used first, and reload on their next get
+		void SetMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+		template <typename T>
+		usage_t GetUsage();
+		const usage_t& GetTotalUsage() const { return usage; }
+		// call after a resource changes its memory use outside of loading
+		void UpdateUsage(ResourceId id);
+
+		// reload resources when their files change under the directory, names are relative to it (the resource path)
+		// only resources loaded after this are reloaded, their names are not kept otherwise
+		bool WatchFiles(const std::string& directory = ".");
+		void StopWatching() { watcher.Shutdown(); }
+		// decode the file of a loaded resource again in the background and upload it into the same resource
+		// resources that depend on it reload after it, a failed reload keeps the previous contents
+		void Reload(const std::string& name);
 
 	private:
-		std::map<std::string, std::shared_ptr<Resource>> resources;
+		struct entry_t
+		{
+			std::shared_ptr<Resource> resource;
+			// position in the type buckets
+			size_t type{ 0 };
+			size_t slot{ 0 };
+			// position in the recently used list, for lru eviction
+			std::list<ResourceId>::iterator recent;
+			// accounted memory, 0 until the resource is ready
+			size_t gpuBytes{ 0 };
+			size_t cpuBytes{ 0 };
+#ifdef _DEBUG
+			// kept to report hash collisions
+			std::string name;
+#endif
+		};
+
+		// load name and data of a resource, kept while watching files to reload it
+		struct source_t
+		{
+			std::string name;
+			void* data{ nullptr };
+		};
+
+		struct pending_t
+		{
+			ResourceId id;
+			std::string name;
+			std::shared_ptr<Resource> resource;
+			void* data{ nullptr };
+			std::future<bool> decoded;
+			// decoded again into a loaded resource
+			bool reload{ false };
+			// the file changed again during the decode, it is reloaded once this job is uploaded
+			bool dirty{ false };
+		};
+
+		// wait for the decode of a pending resource and upload it
+		void Finish(ResourceId id);
+		// upload a decoded job and remove it, returns the next job
+		std::list<pending_t>::iterator Complete(std::list<pending_t>::iterator iter);
+		entry_t* FindEntry(ResourceId id, std::string_view name);
+		void AddEntry(ResourceId id, const std::string& name, std::shared_ptr<Resource> resource, size_t type, void* data);
+		void RemoveEntry(ResourceId id);
+		void Account(entry_t& entry);
+		void Evict();
+		// move a requested resource to the front of the recently used list
+		void Touch(entry_t& entry) { recent.splice(recent.begin(), recent, entry.recent); }
+		template <typename T>
+		static std::shared_ptr<T> Cast(const entry_t& entry);
+		void Upload(pending_t& pending);
+		void Reloaded(pending_t& pending);
+		void ReloadEntry(ResourceId id);
+		void ReloadDependents(ResourceId id);
+
+	private:
+		HashTable<entry_t> resources;
+
+		// resources of each type stored together, indexed by TypeIndex
+		struct bucket_t
+		{
+			std::vector<std::shared_ptr<Resource>> resources;
+			std::vector<ResourceId> ids;
+			usage_t usage;
+		};
+		std::vector<bucket_t> buckets;
+
+		usage_t usage;
+		size_t memoryBudget{ 0 };
+		// most recently requested first, evicted from the back
+		std::list<ResourceId> recent;
+
+		ThreadPool pool;
+		std::list<pending_t> pending;
+		float uploadBudget{ 0.004f };
+
+		FileWatcher watcher;
+		HashTable<source_t> sources;
 	};
 
 	template<typename T>
-	inline std::shared_ptr<T> ResourceSystem::Get(const std::string& name, void* data)
+	inline std::shared_ptr<T> ResourceSystem::Get(ResourceId id, std::string_view name, void* data)
 	{
-		if (resources.find(string_tolower(name)) != resources.end())
+		if (entry_t* entry = FindEntry(id, name))
 		{
-			return std::dynamic_pointer_cast<T>(resources[string_tolower(name)]);
+			Touch(*entry);
+			// a synchronous get of a resource still loading finishes it now
+			if (!entry->resource->IsReady()) Finish(id);
+			return Cast<T>(*entry);
 		}
 		else
 		{
+			std::string path{ name };
 			std::shared_ptr resource = std::make_shared<T>();
-			resource->Load(name, data);
-			resources[string_tolower(name)] = resource;
+			resource->Load(path, data);
+			resource->ready = true;
+			AddEntry(id, path, resource, TypeIndex<T>(), data);
+			Account(*resources.Find(id));
 
 			return resource;
 		}
 	}
 
-	inline void ResourceSystem::Add(const std::string& name, std::shared_ptr<nc::Resource> resource)
+	template<typename T>
+	inline std::shared_ptr<T> ResourceSystem::Find(ResourceId id)
+	{
+		entry_t* entry = resources.Find(id);
+		if (entry == nullptr) return nullptr;
+
+		Touch(*entry);
+		if (!entry->resource->IsReady()) Finish(id);
+		return Cast<T>(*entry);
+	}
+
+	template<typename T>
+	inline std::shared_ptr<T> ResourceSystem::GetAsync(ResourceId id, std::string_view name, void* data)
+	{
+		if (entry_t* entry = FindEntry(id, name))
+		{
+			Touch(*entry);
+			return Cast<T>(*entry);
+		}
+
+		std::string path{ name };
+		std::shared_ptr<T> resource = std::make_shared<T>();
+		AddEntry(id, path, resource, TypeIndex<T>(), data);
+
+		pending_t job;
+		job.id = id;
+		job.name = path;
+		job.resource = resource;
+		job.data = data;
+		job.decoded = pool.Enqueue([resource, path, data]() { return resource->Decode(path, data); });
+		pending.push_back(std::move(job));
+
+		return resource;
+	}
+
+	template<typename T>
+	inline void ResourceSystem::Add(const std::string& name, std::shared_ptr<T> resource)
 	{
-		resources[string_tolower(name)] = resource;
+		resource->ready = true;
+		AddEntry(ResourceId{ name }, name, resource, TypeIndex<T>(), nullptr);
+		Account(*resources.Find(ResourceId{ name }));
+	}
+
+	template<typename T>
+	inline std::shared_ptr<T> ResourceSystem::Cast(const entry_t& entry)
+	{
+		// requests for another type than the one loaded (a base class) fall back to rtti
+		if (entry.type == TypeIndex<T>()) return std::static_pointer_cast<T>(entry.resource);
+		return std::dynamic_pointer_cast<T>(entry.resource);
 	}
 
 	template <typename T>
@@ -53,18 +251,35 @@ namespace nc
 	{
 		std::vector<std::shared_ptr<T>> result;
 
-		for (auto& element : resources)
+		size_t type = TypeIndex<T>();
+		if (type >= buckets.size()) return result;
+
+		result.reserve(buckets[type].resources.size());
+		for (auto& resource : buckets[type].resources)
 		{
-			// get the value of the map (first = key, second = value)
-			// the value is a shared_ptr, get() the raw pointer and try to cast to type T*
-			if (dynamic_cast<T*>(element.second.get()))
-			{
-				// if it is of type T, add the shared pointer to the vector
-				result.push_back(std::dynamic_pointer_cast<T>(element.second));
-			}
+			result.push_back(std::static_pointer_cast<T>(resource));
 		}
 
 		return result;
 	}
 
-}
\ No newline at end of file
+	template <typename T>
+	inline ResourceSystem::usage_t ResourceSystem::GetUsage()
+	{
+		size_t type = TypeIndex<T>();
+		return (type < buckets.size()) ? buckets[type].usage : usage_t{};
+	}
+
+	template <typename T, typename F>
+	inline void ResourceSystem::ForEach(F function)
+	{
+		size_t type = TypeIndex<T>();
+		if (type >= buckets.size()) return;
+
+		for (auto& resource : buckets[type].resources)
+		{
+			function(static_cast<T&>(*resource));
+		}
+	}
+
+}